@@ -1,8 +1,6 @@
 
 
 #include "Action.h"
-#include "HistoryTable.h"
-#include "Settings.h"
 #include "pieces/Pawn.h"
 #include "pieces/Queen.h"
 #include "pieces/Rook.h"
@@ -20,7 +18,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 SimpleAction::SimpleAction(int start_pos, int end_pos, bool promoted, int promoted_type)
    : start_pos(start_pos)
-   , captured(false) // Set in Board::MovePiece
+   , captured(false) // Set in Board::MakeMove
    , promoted(promoted)
    , end_pos(end_pos)
    , promoted_type(promoted_type)
@@ -36,7 +34,7 @@ SimpleAction::SimpleAction(int start_pos, int end_pos, bool promoted, int promot
 ////////////////////////////////////////////////////////////////////////////////
 SimpleAction::SimpleAction(const SimpleAction& other)
    : start_pos(other.start_pos)
-   , captured(false) // Set in Board::MovePiece
+   , captured(false) // Set in Board::MakeMove
    , promoted(other.promoted)
    , end_pos(other.end_pos)
    , promoted_type(other.promoted_type)
@@ -56,8 +54,6 @@ SimpleAction::SimpleAction(const SimpleAction& other)
 Action::Action()
    : SimpleAction(0, 0, false, 0)
    , piece_index(UNKNOWN_INDEX)
-   , history(HistoryTable::Instance()[this])
-   , random(rand())
 {
    
 }
@@ -71,8 +67,6 @@ Action::Action()
 Action::Action(int start_pos, int end_pos, int piece_index, bool promoted, int promoted_type)
    : SimpleAction(start_pos, end_pos, promoted, promoted_type)
    , piece_index(piece_index)
-   , history(HistoryTable::Instance()[this])
-   , random(rand())
 {
    
 }
@@ -91,8 +85,6 @@ Action::Action(const std::string& from_file, int from_rank, const std::string& t
       !promotion.empty() ? Translate::PromotionStrToInt(promotion) : 0
    )
    , piece_index(UNKNOWN_INDEX)
-   , history(HistoryTable::Instance()[this])
-   , random(rand())
 {
    
 }
@@ -111,8 +103,6 @@ Action::Action(const std::string& from, const std::string& to, const std::string
       !promotion.empty() ? Translate::PromotionStrToInt(promotion) : 0
    )
    , piece_index(UNKNOWN_INDEX)
-   , history(HistoryTable::Instance()[this])
-   , random(rand())
 {
    
 }
@@ -126,8 +116,6 @@ Action::Action(const std::string& from, const std::string& to, const std::string
 Action::Action(const Action& other)
    : SimpleAction(other)
    , piece_index(other.piece_index)
-   , history(other.history)
-   , random(other.random)
 {
    
 }
@@ -146,8 +134,6 @@ Action& Action::operator = (const Action& other)
    end_pos       = other.end_pos;
    promoted_type = other.promoted_type;
    piece_index   = other.piece_index;
-   history       = other.history;
-   random        = other.random;
    return *this;
 }
 
@@ -167,24 +153,15 @@ bool Action::operator == (const Action& other) const
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Comparison (greater than) operator
+///   @brief  Comparison (greater than) operator, by position (so actions
+///           can be kept in a sorted container)
 ///
 ////////////////////////////////////////////////////////////////////////////////
 bool Action::operator > (const Action& other) const
 {
-   static const Settings& settings = Settings::Instance();
-   if (settings.test)
-   {
-      return (start_pos >  other.start_pos) ||
-             (start_pos == other.start_pos && end_pos >  other.end_pos) ||
-             (start_pos == other.start_pos && end_pos == other.end_pos && promoted_type > other.promoted_type);
-   }
-   else
-   {
-      // Reverse sign because we want the largest values first
-      return (history >  other.history) ||
-             (history == other.history && random > other.random);
-   }
+   return (start_pos >  other.start_pos) ||
+          (start_pos == other.start_pos && end_pos >  other.end_pos) ||
+          (start_pos == other.start_pos && end_pos == other.end_pos && promoted_type > other.promoted_type);
 }
 
 
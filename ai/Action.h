@@ -25,8 +25,8 @@ struct SimpleAction
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  A more complex action class, with a history table sorting
-///           mechanism
+///   @brief  A more complex action class, which also knows the index of the
+///           piece that moves
 ///
 ////////////////////////////////////////////////////////////////////////////////
 struct Action : public SimpleAction
@@ -45,8 +45,6 @@ struct Action : public SimpleAction
    int PromotionValueDelta() const;
    
    int piece_index;
-   uint64_t history;
-   int random;
 };
 
 
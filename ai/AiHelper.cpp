@@ -2,25 +2,22 @@
 
 #include "AiHelper.h"
 #include "Pondering.h"
-#include "TerminalException.h"
 #include "Timer.h"
 #include "Settings.h"
 #include "io/Error.h"
 #include "io/Debug.h"
+#include <algorithm>
 #include <cstdlib>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <vector>
 
 
-static const HVal TERMINAL_VAL = 1000; // > largest heuristic value
-static const HVal ERROR_VAL    = 2000; // > terminal values
-static const HVal INFINITE     = 3000; // > all other values
+static constexpr HVal ERROR_VAL = hval::MATE + 1000; // > mate values
+static constexpr HVal INFINITE  = hval::MATE + 2000; // > all other values
 
 std::function<HVal(const MyNode&)> AiHelper::s_Heuristic = AiHelper::GoodHeuristic;
-int AiHelper::s_DepthLimit = 0;
-std::pair<HVal, Action> AiHelper::s_BestAction;
-std::deque<Action> AiHelper::s_LastTwoMoves;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -31,7 +28,7 @@ std::deque<Action> AiHelper::s_LastTwoMoves;
 ////////////////////////////////////////////////////////////////////////////////
 HVal AiHelper::LegacyHeuristic(const MyNode& node)
 {
-   return HVal(node.MaterialValueDelta());
+   return node.MaterialValueDelta() * hval::PAWN;
 }
 
 
@@ -44,7 +41,22 @@ HVal AiHelper::LegacyHeuristic(const MyNode& node)
 ////////////////////////////////////////////////////////////////////////////////
 HVal AiHelper::GoodHeuristic(const MyNode& node)
 {
-   return HVal(node.MaterialValueDelta(), node.NumMovesDelta());
+   return node.MaterialValueDelta() * hval::PAWN + node.NumMovesDelta() * hval::MOBILITY;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// 
+///   @brief  A heuristic to weigh a node by the material and where each
+///           piece stands, tapered from the midgame to the endgame (see Pst)
+///           
+///           The board keeps the score up to date as moves are made, so
+///           unlike the mobility this doesn't have to generate any moves.
+/// 
+////////////////////////////////////////////////////////////////////////////////
+HVal AiHelper::PstHeuristic(const MyNode& node)
+{
+   return node.GetState().Evaluate() * -node.Sign(); // For the root's turn player
 }
 
 
@@ -59,21 +71,10 @@ HVal AiHelper::GoodHeuristic(const MyNode& node)
 ////////////////////////////////////////////////////////////////////////////////
 Action AiHelper::Random(const State& state)
 {
-   std::set<Action, std::greater<Action> > actions;
-   state.GetValidActions(actions);
-   ASSERT(!actions.empty());
-   int i = rand() % actions.size();
-   const Action* pAction = nullptr;
-   for (const Action& action : actions)
-   {
-      if (i == 0)
-      {
-         pAction = &action;
-      }
-      --i;
-   }
-   ASSERT_NE(nullptr, pAction);
-   return *pAction;
+   MoveList moves;
+   state.GetValidActions(moves);
+   ASSERT(!moves.Empty());
+   return moves.Get(rand() % moves.Size());
 }
 
 
@@ -81,8 +82,15 @@ Action AiHelper::Random(const State& state)
 ///
 ///   @brief  Iterative Deepening Depth Limited Mini Max
 ///
+///           With more than one thread in the settings, helper threads search
+///           the same root at the same time (lazy SMP). They share the
+///           transposition table, so the main thread finds more of its
+///           nodes already searched.
+///
+///   @param context  The search's own board, killers, history, etc. (kept
+///                   between searches)
 ///   @param state  The starting state for the search
-///   @param L  The depth limit for the search (++ with recursive call)
+///   @param L  The first depth limit for the search
 ///             
 ///             Starts at 1, because the chess framework will detect same turn
 ///             game-ending states for us. I.e. this function doesn't get called
@@ -92,32 +100,68 @@ Action AiHelper::Random(const State& state)
 ///            of returning if a solution is found
 ///
 ////////////////////////////////////////////////////////////////////////////////
-Action AiHelper::ID_DL_MiniMax(const State& state, int L)
+Action AiHelper::ID_DL_MiniMax(SearchContext& context, const State& state, int L)
+{
+   static const Settings& settings = Settings::Instance();
+   
+   // Keep what the table has from earlier searches, but replace it first
+   TranspositionTable::Instance().NewSearch();
+   context.ClearKillers(); // Keep them between depths, not turns
+   context.rootValue = INFINITE; // Nothing to aim the first window at
+   context.bestAction = std::pair<HVal, Action>(); // The last one was for another root
+   context.stableDepths = 0;
+   context.lastDepthNodes = 0;
+   
+   State root(state, context.board); // Only this search changes its board
+   HelperThreads helpers(context, root, settings.threads - 1);
+   return IterativeDeepening(context, helpers, root, L);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Search the main thread's depth limit, then do it again one
+///           deeper (unless we are done)
+///
+///   @param L  The depth limit for the search (++ with recursive call)
+///
+////////////////////////////////////////////////////////////////////////////////
+Action AiHelper::IterativeDeepening(SearchContext& context, HelperThreads& helpers, const State& state, int L)
 {
    static const Settings& settings = Settings::Instance();
-   s_DepthLimit = L;
+   context.depthLimit = L;
    debug::Print("depth limit = " + std::to_string(L));
    
-   bool outOfTime = false;
-   try
+   context.status = SearchContext::SEARCHING;
+   const double start = Timer::Instance().Elapsed();
+   const uint64_t startNodes = context.nodes;
+   MyNode node(state);
+   std::pair<HVal, Action> action = GetBestAction_Aspiration(context, node);
+   
+   // The search doesn't throw to stop, so this is where pondering does
+   if (context.status == SearchContext::DONE_PONDERING)
+   {
+      throw DonePonderingException();
+   }
+   
+   bool outOfTime = (context.status == SearchContext::OUT_OF_TIME);
+   bool kept = false;
+   HVal lastValue = context.rootValue;
+   if (!outOfTime)
    {
-      MyNode node(state);
-      std::pair<HVal, Action> action = GetMaxAction_Root(node, -INFINITE, INFINITE);
+      context.stableDepths = (action.second == context.bestAction.second) ? context.stableDepths + 1 : 0;
+      context.rootValue = action.first;
       
       // If we are only using even depths we won't keep the retrieved action
       // unless it is terminal
-      if (!settings.even_depths_only || L % 2 == 0 || s_BestAction.first >= TERMINAL_VAL)
+      if (!settings.even_depths_only || L % 2 == 0 || hval::IsMate(action.first))
       {
-         s_BestAction = action;
+         context.bestAction = action;
+         kept = true;
       }
    }
-   catch (const TerminalException&)
-   {
-      EXIT("Expected at least one action!");
-   }
-   catch (const OutOfTimeException&)
+   else
    {
-      outOfTime = true;
       if (L > MIN_DEPTH_LIMIT)
       {
          std::ostringstream oss;
@@ -130,140 +174,368 @@ Action AiHelper::ID_DL_MiniMax(const State& state, int L)
       }
    }
    
-   if (!Pondering::Instance().Running())
+   // Take a helper's action if it finished a deeper search first
+   std::pair<HVal, Action> helperAction;
+   int helperDepth = helpers.TakeResult(helperAction);
+   if (helperDepth > (outOfTime ? L - 1 : L) && (!settings.even_depths_only || helperDepth % 2 == 0))
    {
-      if (outOfTime || s_BestAction.first >= TERMINAL_VAL || (settings.max_depth_limit > 0 && L >= settings.max_depth_limit))
+      context.bestAction = helperAction;
+      L = std::max(L, helperDepth);
+      kept = true;
+   }
+   
+   if (kept && context.onDepth)
+   {
+      context.depthLimit = L;
+      context.onDepth(context);
+   }
+   
+   if (!context.pondering)
+   {
+      if (outOfTime || MateProven(context.bestAction.first, L) || (settings.max_depth_limit > 0 && L >= settings.max_depth_limit) ||
+          StopAfterDepth(context, L, lastValue, action.first, Timer::Instance().Elapsed() - start, context.nodes - startNodes))
       {
-         // Track moves to avoid 3 move repetition draw
-         s_LastTwoMoves.push_front(s_BestAction.second);
-         if (s_LastTwoMoves.size() > 2)
+         return context.bestAction.second;
+      }
+   }
+   return IterativeDeepening(context, helpers, state, L + 1);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Start the helper threads (if any)
+///
+///   @param context  The main thread's context
+///   @param state  The root (bound to the main thread's board, so each helper
+///                 makes a copy on its own board)
+///
+////////////////////////////////////////////////////////////////////////////////
+AiHelper::HelperThreads::HelperThreads(SearchContext& context, const State& state, int numHelpers)
+   : m_Context(context)
+   , m_State(state)
+   , m_GameKeys(context.gameKeys)
+   , m_Threads()
+   , m_Stop(false)
+   , m_Nodes(0)
+   , m_Mutex()
+   , m_Depth(0)
+   , m_Action()
+{
+   for (int i = 0; i < numHelpers; ++i)
+   {
+      m_Threads.emplace_back(Run, this, i);
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Stop the helper threads and wait for them to finish. Their nodes
+///           are added to the main thread's count.
+///
+////////////////////////////////////////////////////////////////////////////////
+AiHelper::HelperThreads::~HelperThreads()
+{
+   m_Stop = true;
+   for (std::thread& thread : m_Threads)
+   {
+      thread.join();
+   }
+   m_Context.nodes += m_Nodes;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the deepest search a helper has finished
+///
+///   @param action  Populated with the action from that search
+///
+///   @return  The search's depth limit (0 if none have finished)
+///
+////////////////////////////////////////////////////////////////////////////////
+int AiHelper::HelperThreads::TakeResult(std::pair<HVal, Action>& action)
+{
+   std::lock_guard<std::mutex> lock(m_Mutex);
+   action = m_Action;
+   return m_Depth;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Run a helper thread's iterative deepening, until the main thread
+///           says to stop
+///
+///           Every other helper starts a ply deeper, so the helpers aren't
+///           all searching the same nodes in the same order.
+///
+///   @param index  Which helper this is
+///
+////////////////////////////////////////////////////////////////////////////////
+void AiHelper::HelperThreads::Run(HelperThreads* pHelpers, int index)
+{
+   static const Settings& settings = Settings::Instance();
+   std::unique_ptr<SearchContext> pContext(new SearchContext());
+   SearchContext& context = *pContext;
+   context.gameKeys = pHelpers->m_GameKeys;
+   context.pondering = pHelpers->m_Context.pondering;
+   context.pStop = &pHelpers->m_Stop;
+   context.rootValue = INFINITE;
+   try
+   {
+      State state(pHelpers->m_State, context.board);
+      for (int L = MIN_DEPTH_LIMIT + index % 2; ; ++L)
+      {
+         context.depthLimit = L;
+         context.status = SearchContext::SEARCHING;
+         MyNode node(state);
+         std::pair<HVal, Action> action = GetBestAction_Aspiration(context, node);
+         if (Stopped(context))
          {
-            s_LastTwoMoves.pop_back();
+            break;
+         }
+         context.rootValue = action.first;
+         pHelpers->PostResult(L, action);
+         if (MateProven(action.first, L) || (settings.max_depth_limit > 0 && L >= settings.max_depth_limit))
+         {
+            break;
          }
-         return s_BestAction.second;
       }
    }
-   return ID_DL_MiniMax(state, L + 1);
+   catch (const Error& e) // Shouldn't happen
+   {
+      debug::Print(e.what());
+   }
+   pHelpers->m_Nodes += context.nodes;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
-/// 
-///   @brief  Get the action with the max heuristic value for this depth
-///           
-///           This root version of GetMaxAction avoids a 3-move repetition
-///           draw and quits early if it encounters a terminal state
-/// 
+///
+///   @brief  Hand the main thread a finished search, if it is the deepest
+///           one a helper has finished
+///
 ////////////////////////////////////////////////////////////////////////////////
-std::pair<HVal, Action> AiHelper::GetMaxAction_Root(MyNode& node, HVal alpha, HVal beta)
+void AiHelper::HelperThreads::PostResult(int L, const std::pair<HVal, Action>& action)
 {
-   // Quit if this is as far as we go
-   if (AtDepthLimit(node))
+   std::lock_guard<std::mutex> lock(m_Mutex);
+   if (L > m_Depth)
    {
-      HVal leaf_val = s_Heuristic(node);
-      return std::make_pair(leaf_val, node.GetAction());
+      m_Depth = L;
+      m_Action = action;
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Search the root with a narrow (aspiration) window around the
+///           value from the last depth limit. If the value falls outside of
+///           it, widen that side and search again, until it is the full
+///           window.
+///
+///           Most of the time the value doesn't change much from one depth
+///           to the next, so the narrow window prunes more.
+///
+///           When only searching for a mate, the window is set by the number
+///           of moves instead (see GetBestAction_Mate).
+///
+////////////////////////////////////////////////////////////////////////////////
+std::pair<HVal, Action> AiHelper::GetBestAction_Aspiration(SearchContext& context, MyNode& node)
+{
+   static const Settings& settings = Settings::Instance();
+   if (settings.mate_moves > 0)
+   {
+      return GetBestAction_Mate(context, node, settings.mate_moves);
+   }
+   HVal guess = context.rootValue;
+   if (!settings.alpha_beta || !settings.pvs || hval::IsMate(guess) || guess == INFINITE)
+   {
+      return GetBestAction(context, node, -INFINITE, INFINITE);
    }
    
-   // Get children
-   std::vector<MyNode> successors;
-   node.GetSuccessors(successors);
-   
-   // Check things like how much time we have left
-   MaybeQuitEarly();
-   
-   // Iterate over successor nodes
-   std::pair<HVal, MyNode*> max = std::make_pair(-INFINITE, nullptr);
-   std::map<HVal, std::vector<MyNode*> > sorted;
-   for (MyNode& successor : successors)
+   int lowDelta = ASPIRATION_DELTA;
+   int highDelta = ASPIRATION_DELTA;
+   while (true)
    {
-      // Filter top-level moves to avoid a 3 move repetition draw
-      if (!node.GetParent() && s_LastTwoMoves.size() >= 2 && successors.size() >= 2)
+      HVal alpha = (lowDelta > MAX_ASPIRATION_DELTA) ? -INFINITE : guess - lowDelta;
+      HVal beta = (highDelta > MAX_ASPIRATION_DELTA) ? INFINITE : guess + highDelta;
+      std::pair<HVal, Action> best = GetBestAction(context, node, alpha, beta);
+      if (Stopped(context))
       {
-         if (successor.GetAction() == s_LastTwoMoves.back())
-         {
-            continue;
-         }
+         return best;
       }
-      
-      // Store the value
-      HVal rollup = GetMinActionWrapper(successor, alpha, beta);
-      if (rollup > max.first)
+      if (best.first <= alpha && alpha > -INFINITE)
       {
-         max.first = rollup;
-         max.second = &successor;
+         lowDelta *= 2; // Fail low - the value could be even lower
       }
-      sorted[rollup].push_back(&successor); // For debug printing
-      
-      // Quit if we found a terminal state
-      if (!Pondering::Instance().Running() && rollup >= TERMINAL_VAL)
+      else if (best.first >= beta && beta < INFINITE)
       {
-         break;
+         highDelta *= 2; // Fail high - the value could be even higher
       }
-      
-      // Alpha beta pruning?
-      static const Settings& settings = Settings::Instance();
-      if (settings.alpha_beta)
+      else
       {
-         if (rollup >= beta)
-         {
-            if (rollup != max.first) { ++successor; } // Update history table
-            break; // Fail High - Prune!
-         }
-         if (rollup > alpha)
-         {
-            alpha = rollup;
-         }
+         return best;
       }
    }
-   ASSERT_NE(nullptr, max.second);
-   DebugPrint(node, sorted, max);
-   ++(*max.second); // Update history table
-   return std::make_pair(max.first, max.second->GetAction());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Search the root for a mate in the number of moves, and nothing
+///           else. The window starts just below the slowest mate that
+///           counts, so every line without one fails low right away (and
+///           null moves, which are never tried near a mate, are skipped).
+///
+///   @return  The mate's value, or at most 0 if there isn't one (its action
+///            is then just one of the valid actions)
+///
+////////////////////////////////////////////////////////////////////////////////
+std::pair<HVal, Action> AiHelper::GetBestAction_Mate(SearchContext& context, MyNode& node, int moves)
+{
+   HVal alpha = hval::MATE - 2 * moves; // Mate in 'moves' is MATE - (2 * moves - 1)
+   std::pair<HVal, Action> best = GetBestAction(context, node, alpha, INFINITE);
+   if (best.first <= alpha)
+   {
+      best.first = std::min(best.first, 0); // Only an upper bound
+   }
+   return best;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 /// 
-///   @brief  Get the action with the max heuristic value for this depth
+///   @brief  Get the action with the max heuristic value for this depth, for
+///           the node's turn player (negamax). Values and the alpha beta
+///           window are from the turn player's point of view, so each
+///           successor's value is negated (and its window flipped).
+///           
+///           Below the root, a node can be pruned by passing (see
+///           NullMovePrunes), and late actions are searched less deep (see
+///           LateMoveReduction). Checks and forced replies are searched
+///           deeper (see Extension).
+///           
+///           A node that repeats an earlier state, or is past the 50 move
+///           rule, is a draw, so it isn't searched (see IsDraw).
+///           
+///           The root can't use the table's value (it needs an action), and
+///           it quits early if it encounters a terminal state.
 /// 
 ////////////////////////////////////////////////////////////////////////////////
-std::pair<HVal, Action> AiHelper::GetMaxAction(MyNode& node, HVal alpha, HVal beta)
+std::pair<HVal, Action> AiHelper::GetBestAction(SearchContext& context, MyNode& node, HVal alpha, HVal beta)
 {
-   // Quit if this is as far as we go
-   if (AtDepthLimit(node))
+   static const Settings& settings = Settings::Instance();
+   bool root = !node.GetParent();
+   
+   // The path to each node starts with the game's states before the root
+   if (root)
+   {
+      context.keys = context.gameKeys;
+   }
+   else if (IsDraw(context, node))
    {
-      HVal leaf_val = s_Heuristic(node);
-      return std::make_pair(leaf_val, node.GetAction());
+      return std::make_pair(0, node.GetAction());
    }
+   SearchContext::KeyGuard keyGuard(context, node.GetState().Key());
+   
+   // Past the depth limit, only the captures are searched
+   if (DepthLeft(context, node) <= 0)
+   {
+      return std::make_pair(Quiesce(context, node, alpha, beta), node.GetAction());
+   }
+   ++context.nodes;
+   
+   // No mate from here can be quicker than mating on the next ply, or slower
+   // than being mated now (mate distance pruning)
+   if (!root && settings.alpha_beta)
+   {
+      alpha = std::max(alpha, hval::Mated(node.Depth()));
+      beta = std::min(beta, hval::MATE - node.Depth() - 1);
+      if (alpha >= beta)
+      {
+         return std::make_pair(alpha, node.GetAction());
+      }
+   }
+   
+   // Use the table to cut off the search, or at least try its best action first
+   TranspositionTable::Entry entry;
+   if (ProbeTable(context, node, alpha, beta, entry) && !root)
+   {
+      return std::make_pair(entry.value, node.GetAction());
+   }
+   HVal originalAlpha = alpha;
+   
+   // If passing still fails high, a real action surely would
+   if (!root && NullMovePrunes(context, node, alpha, beta))
+   {
+      return std::make_pair(beta, node.GetAction());
+   }
+   const bool inCheck = node.GetState().InCheck();
    
    // Get children
-   std::vector<MyNode> successors;
-   node.GetSuccessors(successors);
+   Successors successors(context, node, entry.hasAction ? &entry.action : nullptr);
+   if (successors.Size() == 0)
+   {
+      if (root)
+      {
+         EXIT("Expected at least one action!");
+      }
+      return std::make_pair(TerminalValue(node), node.GetAction());
+   }
    
    // Check things like how much time we have left
-   MaybeQuitEarly();
+   if (MaybeQuitEarly(context))
+   {
+      return std::make_pair(0, node.GetAction()); // Ignored (see Stopped)
+   }
    
-   // Iterate over successor nodes
-   std::pair<HVal, MyNode*> max = std::make_pair(-INFINITE, nullptr);
-   std::map<HVal, std::vector<MyNode*> > sorted;
-   for (MyNode& successor : successors)
-   {
-      // Store the value
-      HVal rollup = GetMinActionWrapper(successor, alpha, beta);
-      if (rollup > max.first)
+   // Iterate over successor nodes (only made as they are needed)
+   std::pair<HVal, Action> best = std::make_pair(-INFINITE, Action());
+   int numSearched = 0;
+#ifdef SEARCH_TRACE
+   std::map<HVal, std::vector<Action> > sorted;
+#endif
+   while (MyNode* pSuccessor = successors.Next())
+   {
+      MyNode& successor = *pSuccessor;
+      
+      // Store the value (forcing actions are searched deeper, and late actions less deep first)
+      successor.Reduce(-Extension(context, node, successors, successor, inCheck));
+      int reduction = root ? 0 : LateMoveReduction(context, node, successors, successor, numSearched, inCheck);
+      HVal rollup = GetSuccessorValue_PVS(context, successor, alpha, beta, best.first == -INFINITE, reduction);
+      ++numSearched;
+      if (Stopped(context))
+      {
+         return best; // Don't store or count anything from an unfinished search
+      }
+      if (rollup > best.first)
       {
-         max.first = rollup;
-         max.second = &successor;
+         best.first = rollup;
+         best.second = successor.GetAction();
+      }
+#ifdef SEARCH_TRACE
+      if (ShouldPrint(context, node))
+      {
+         sorted[rollup].push_back(successor.GetAction()); // For debug printing
+      }
+#endif
+      
+      // Quit if we found a mate that can't be beat
+      if (root && !context.pondering && rollup >= hval::MATE - 1)
+      {
+         break;
       }
-      sorted[rollup].push_back(&successor); // For debug printing
       
       // Alpha beta pruning?
-      static const Settings& settings = Settings::Instance();
       if (settings.alpha_beta)
       {
          if (rollup >= beta)
          {
-            if (rollup != max.first) { ++successor; } // Update history table
+            if (rollup != best.first) { UpdateHistory(context, successor.GetAction()); }
+            if (Quiescent(successor.GetAction())) { context.AddKiller(node.Depth(), successor.GetAction()); }
             break; // Fail High - Prune!
          }
          if (rollup > alpha)
@@ -272,182 +544,474 @@ std::pair<HVal, Action> AiHelper::GetMaxAction(MyNode& node, HVal alpha, HVal be
          }
       }
    }
-   ASSERT_NE(nullptr, max.second);
-   DebugPrint(node, sorted, max);
-   ++(*max.second); // Update history table
-   return std::make_pair(max.first, max.second->GetAction());
+   ASSERT_GT(best.first, -INFINITE);
+#ifdef SEARCH_TRACE
+   DebugPrint(context, node, sorted, best);
+#endif
+   StoreTable(context, node, originalAlpha, beta, best);
+   UpdateHistory(context, best.second);
+   return best;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 /// 
-///   @brief  We don't want to just use the GetMaxAction return value as-is.
-///           Adjust the sign depending on depth. Account for terminal states.
+///   @brief  We only need the GetBestAction value. If something goes wrong
+///           (shouldn't happen), the error value keeps the parent from
+///           choosing the node.
 /// 
 ////////////////////////////////////////////////////////////////////////////////
-HVal AiHelper::GetMaxActionWrapper(MyNode& node, HVal alpha, HVal beta)
+HVal AiHelper::GetBestActionWrapper(SearchContext& context, MyNode& node, HVal alpha, HVal beta)
 {
    try
    {
-      return GetMaxAction(node, alpha, beta).first;
+      return GetBestAction(context, node, alpha, beta).first;
    }
-   catch (const CheckmateException&)
+   catch(const Error& e) // Shouldn't happen
    {
-      return TERMINAL_VAL * node.Sign();
+      debug::Print(e.what());
+      return ERROR_VAL;
    }
-   catch (const StalemateException&)
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get a successor's value (for its parent) with a principal
+///           variation search. Once the first successor sets alpha, the rest
+///           are only searched to prove they can't raise it (a null window
+///           at alpha), and searched again with the full window if they can.
+///
+///           A reduced successor is searched less deep with the null window
+///           first, and only searched again to the full depth if it raises
+///           alpha.
+///
+///   @param first  If this is the first successor (searched with the full
+///                 window)
+///   @param reduction  Plies to search the successor less deep at first
+///
+////////////////////////////////////////////////////////////////////////////////
+HVal AiHelper::GetSuccessorValue_PVS(SearchContext& context, MyNode& successor, HVal alpha, HVal beta, bool first,
+                                     int reduction)
+{
+   static const Settings& settings = Settings::Instance();
+   if (reduction > 0)
    {
-      return -TERMINAL_VAL * node.Sign();
+      successor.Reduce(reduction);
+      HVal rollup = -GetBestActionWrapper(context, successor, -(alpha + 1), -alpha);
+      successor.Reduce(-reduction);
+      if (rollup <= alpha || Stopped(context))
+      {
+         return rollup;
+      }
    }
-   catch(const Error& e) // Shouldn't happen
+   if (first || !settings.alpha_beta || !settings.pvs)
    {
-      debug::Print(e.what());
-      return -ERROR_VAL * node.Sign();
+      return -GetBestActionWrapper(context, successor, -beta, -alpha);
    }
+   HVal rollup = -GetBestActionWrapper(context, successor, -(alpha + 1), -alpha);
+   if (rollup > alpha && rollup < beta && !Stopped(context))
+   {
+      rollup = -GetBestActionWrapper(context, successor, -beta, -alpha); // Re-search
+   }
+   return rollup;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
-/// 
-///   @brief  Get the action with the max heuristic value for this depth
-/// 
+///
+///   @brief  Null-move pruning: let the turn player pass, and search what
+///           the other player can do with the free move (less deep, with a
+///           null window at beta). If the turn player is still doing well
+///           enough to fail high, any real action would too (almost always),
+///           so the node is pruned.
+///
+///           Passing is only tried in a null window (not on the principal
+///           variation), never twice in a row, and never in check. It isn't
+///           tried with only pawns and the king left either, since then the
+///           turn player could be in zugzwang (every real action makes it
+///           worse than passing would).
+///
+///   @return  true if the node fails high (prune it)
+///
 ////////////////////////////////////////////////////////////////////////////////
-std::pair<HVal, Action> AiHelper::GetMinAction(MyNode& node, HVal alpha, HVal beta)
+bool AiHelper::NullMovePrunes(SearchContext& context, MyNode& node, HVal alpha, HVal beta)
 {
-   // Quit if this is as far as we go
-   if (AtDepthLimit(node))
+   static const Settings& settings = Settings::Instance();
+   const int depthLeft = DepthLeft(context, node);
+   if (!settings.alpha_beta || !settings.null_move || beta - alpha > 1 || node.IsNullMove() ||
+       depthLeft < NULL_MOVE_MIN_DEPTH || hval::IsMate(beta))
+   {
+      return false;
+   }
+   const State& state = node.GetState();
+   if (state.InCheck() || !state.HasNonPawnMaterial() || s_Heuristic(node) * -node.Sign() < beta)
    {
-      HVal leaf_val = s_Heuristic(node);
-      return std::make_pair(leaf_val, node.GetAction());
+      return false;
    }
    
-   // Get children
-   std::vector<MyNode> successors;
-   node.GetSuccessors(successors);
+   int reduction = NULL_MOVE_REDUCTION + (depthLeft >= REDUCTION_DEEP ? 1 : 0);
+   MyNode nullNode(node); // Made into the null successor below
+   nullNode.MakeNullSuccessor(node, reduction);
+   HVal value = -GetBestActionWrapper(context, nullNode, -beta, -(beta - 1));
+   ASSERT(nullNode.GetState().UnmakeAction());
+   return value >= beta && !Stopped(context);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Late move reductions: the move picker orders the actions most
+///           likely to cut off first, so a quiet action that comes after the
+///           killers (ordered by the history table) or a capture that loses
+///           material (by SEE) is searched less deep, unless something makes
+///           it tactical (a check or a promotion)
+///
+///   @param numSearched  The successors searched before this one
+///   @param inCheck  If the node's turn player is in check
+///
+///   @return  The plies to reduce the successor by (0 for none)
+///
+////////////////////////////////////////////////////////////////////////////////
+int AiHelper::LateMoveReduction(const SearchContext& context, const MyNode& node, const Successors& successors,
+                                const MyNode& successor, int numSearched, bool inCheck)
+{
+   static const Settings& settings = Settings::Instance();
+   const int depthLeft = DepthLeft(context, node);
+   if (!settings.alpha_beta || !settings.lmr || depthLeft < LMR_MIN_DEPTH || numSearched < LMR_MIN_ACTIONS ||
+       !successors.Late() || inCheck || successor.GetAction().promoted || successor.GetState().InCheck())
+   {
+      return 0;
+   }
+   return (depthLeft >= REDUCTION_DEEP && numSearched >= 2 * LMR_MIN_ACTIONS) ? 2 : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Extend the search a ply past a check, or past the only way out
+///           of a check, so forced lines (like a mate) are followed to the
+///           end instead of stopping at an arbitrary depth
+///
+///           Whether the successor is in check comes from the board's masks,
+///           which its actions are generated from anyway. No extensions are
+///           made past MAX_EXTENSION_FACTOR times the depth limit, so a long
+///           series of checks can't run on forever.
+///
+///   @param inCheck  If the node's turn player is in check
+///
+///   @return  The plies to extend the successor by (0 for none)
+///
+////////////////////////////////////////////////////////////////////////////////
+int AiHelper::Extension(const SearchContext& context, const MyNode& node, const Successors& successors,
+                        const MyNode& successor, bool inCheck)
+{
+   static const Settings& settings = Settings::Instance();
+   if (!settings.extensions || node.Depth() >= MAX_EXTENSION_FACTOR * context.depthLimit)
+   {
+      return 0;
+   }
+   bool oneReply = inCheck && successors.Size() == 1;
+   return (oneReply || successor.GetState().InCheck()) ? 1 : 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Search just the captures and promotions past the depth limit,
+///           until the position is quiet, so the heuristic is never taken in
+///           the middle of an exchange (quiescence search)
+///
+///           The turn player can always "stand pat" on the heuristic value
+///           instead of capturing, so that is the least the node is worth.
+///           Captures are picked by MVV-LVA, and not searched at all if they
+///           can't raise alpha even with a margin on top of the piece (delta
+///           pruning). Captures that lose material in the trade that
+///           follows (by SEE) are left out by the move picker.
+///
+///           In check there is no standing pat, so every action is searched
+///           (and no actions means checkmate).
+///
+////////////////////////////////////////////////////////////////////////////////
+HVal AiHelper::Quiesce(SearchContext& context, MyNode& node, HVal alpha, HVal beta)
+{
+   static const Settings& settings = Settings::Instance();
+   ++context.nodes;
    
-   // Check things like how much time we have left
-   MaybeQuitEarly();
+   const bool inCheck = settings.quiescent && node.GetState().InCheck();
+   HVal standPat = inCheck ? -INFINITE : s_Heuristic(node) * -node.Sign(); // For the turn player
+   if (!settings.quiescent || standPat >= beta)
+   {
+      return standPat;
+   }
+   HVal best = standPat;
+   alpha = std::max(alpha, standPat);
    
-   // Iterate over successor nodes
-   std::pair<HVal, MyNode*> min = std::make_pair(INFINITE, nullptr);
-   std::map<HVal, std::vector<MyNode*> > sorted;
-   for (MyNode& successor : successors)
-   {
-      // Store the value
-      HVal rollup = GetMaxActionWrapper(successor, alpha, beta);
-      if (rollup < min.first)
+   Successors successors(context, node, nullptr, !inCheck);
+   if (inCheck && successors.Size() == 0)
+   {
+      return TerminalValue(node);
+   }
+   while (MyNode* pSuccessor = successors.Next())
+   {
+      MyNode& successor = *pSuccessor;
+      if (!inCheck)
       {
-         min.first = rollup;
-         min.second = &successor;
+         HVal gain = (successor.MaterialValueDelta() - node.MaterialValueDelta()) * -node.Sign() * hval::PAWN;
+         if (!successor.GetAction().promoted && standPat + gain + DELTA_MARGIN <= alpha)
+         {
+            continue; // Delta pruning
+         }
       }
-      sorted[rollup].push_back(&successor); // For debug printing
       
-      // Alpha beta pruning?
-      static const Settings& settings = Settings::Instance();
-      if (settings.alpha_beta)
+      HVal value = -Quiesce(context, successor, -beta, -alpha);
+      if (value > best)
       {
-         if (rollup <= alpha)
-         {
-            if (rollup != min.first) { ++successor; } // Update history table
-            break; // Fail Low - Prune!
-         }
-         if (rollup < beta)
-         {
-            beta = rollup;
-         }
+         best = value;
+      }
+      if (value >= beta)
+      {
+         break; // Fail High - Prune!
+      }
+      if (value > alpha)
+      {
+         alpha = value;
       }
    }
-   ASSERT_NE(nullptr, min.second);
-   DebugPrint(node, sorted, min);
-   ++(*min.second); // Update history table
-   return std::make_pair(min.first, min.second->GetAction());
+   return best;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
-/// 
-///   @brief  We don't want to just use the GetMinAction return value as-is.
-///           Account for terminal states. Adjust the sign depending on depth.
-/// 
+///
+///   @brief  Look the node up in the transposition table
+///
+///   @param entry  Populated with the table's entry for the node (if any)
+///
+///   @return  true if the entry was searched deep enough that its value can
+///            be used instead of searching the node again
+///
 ////////////////////////////////////////////////////////////////////////////////
-HVal AiHelper::GetMinActionWrapper(MyNode& node, HVal alpha, HVal beta)
+bool AiHelper::ProbeTable(const SearchContext& context, const MyNode& node, HVal alpha, HVal beta, TranspositionTable::Entry& entry)
 {
-   try
+   if (!TranspositionTable::Instance().Probe(node.GetState().Key(), entry))
    {
-      return GetMinAction(node, alpha, beta).first;
+      return false;
    }
-   catch (const CheckmateException&)
+   entry.value = hval::FromTable(entry.value, node.Depth());
+   if (entry.depth < DepthLeft(context, node))
    {
-      return TERMINAL_VAL * node.Sign();
+      return false;
    }
-   catch (const StalemateException&)
+   switch (entry.bound)
    {
-      return -TERMINAL_VAL * node.Sign();
+      case TranspositionTable::EXACT: return true;
+      case TranspositionTable::LOWER: return entry.value >= beta;
+      case TranspositionTable::UPPER: return entry.value <= alpha;
+      default: return false;
    }
-   catch(const Error& e) // Shouldn't happen
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Store the node's value in the transposition table
+///
+///   @param alpha  The alpha the node was searched with (before updates)
+///   @param beta  The beta the node was searched with (before updates)
+///   @param best  The node's value and the action it came from
+///
+////////////////////////////////////////////////////////////////////////////////
+void AiHelper::StoreTable(const SearchContext& context, const MyNode& node, HVal alpha, HVal beta, const std::pair<HVal, Action>& best)
+{
+   TranspositionTable::Bound bound = TranspositionTable::EXACT;
+   if (best.first <= alpha)
    {
-      debug::Print(e.what());
-      return -ERROR_VAL * node.Sign();
+      bound = TranspositionTable::UPPER; // Fail low - could be even lower
+   }
+   else if (best.first >= beta)
+   {
+      bound = TranspositionTable::LOWER; // Fail high - could be even higher
+   }
+   TranspositionTable::Instance().Store(node.GetState().Key(), DepthLeft(context, node), bound,
+                                        hval::ToTable(best.first, node.Depth()), &best.second);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Count the action in the history table (if it is turned on)
+///
+////////////////////////////////////////////////////////////////////////////////
+void AiHelper::UpdateHistory(SearchContext& context, Action action)
+{
+   static const Settings& settings = Settings::Instance();
+   if (settings.history_table)
+   {
+      ++context.history[&action];
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Check to see if a root value is a mate (for either player) that
+///           was found within the depth limit, so searching deeper would
+///           only find the same mate again
+///
+///           A mate past the depth limit (found by extensions) isn't proven
+///           to be the quickest, since not every line was searched that deep.
+///
+////////////////////////////////////////////////////////////////////////////////
+bool AiHelper::MateProven(HVal value, int L)
+{
+   return hval::IsMate(value) && hval::MatePlies(value) <= L;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get how many more plies to search below the node before the
+///           quiescence search takes over (less any reductions on the way)
+///
+////////////////////////////////////////////////////////////////////////////////
+int AiHelper::DepthLeft(const SearchContext& context, const MyNode& node)
+{
+   return context.depthLimit - node.Depth() - node.Reduction();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Check if there is time to search another depth limit (see Timer).
+///           Less of the soft limit is used once the best action has stayed
+///           the same for a few depth limits, and more when the value drops.
+///           Even before the soft limit, a depth limit isn't started if it
+///           couldn't finish before the hard limit, going by how much longer
+///           this one took than the last (the effective branching factor).
+///
+///   @param lastValue  From the last depth limit (INFINITE if none)
+///   @param value  From this depth limit
+///   @param seconds  This depth limit took
+///   @param nodes  This depth limit searched
+///
+///   @return  true if the search should stop with this depth limit's action
+///
+////////////////////////////////////////////////////////////////////////////////
+bool AiHelper::StopAfterDepth(SearchContext& context, int L, HVal lastValue, HVal value, double seconds, uint64_t nodes)
+{
+   static const Settings& settings = Settings::Instance();
+   const uint64_t lastNodes = context.lastDepthNodes;
+   context.lastDepthNodes = nodes;
+   if (L <= settings.min_depth_limit)
+   {
+      return false;
    }
+   
+   double scale = 1.0;
+   if (context.stableDepths >= STABLE_DEPTHS)
+   {
+      scale *= STABLE_SCALE;
+   }
+   if (lastValue != INFINITE && !hval::IsMate(lastValue) && !hval::IsMate(value) && lastValue - value >= SCORE_DROP)
+   {
+      scale *= SCORE_DROP_SCALE;
+   }
+   const Timer& timer = Timer::Instance();
+   if (timer.PastSoftLimit(scale))
+   {
+      return true;
+   }
+   return lastNodes > 0 && !timer.CanFinish(seconds * nodes / lastNodes);
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  If we are pondering or have a time limit, we might need to quit
-///           before finishing
+///           before finishing. Helper threads also quit when the main thread
+///           is done.
+///
+///   @return  true if the search should stop (see Stopped)
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void AiHelper::MaybeQuitEarly()
+bool AiHelper::MaybeQuitEarly(SearchContext& context)
 {
    static const Settings& settings = Settings::Instance();
-   if (s_DepthLimit > settings.min_depth_limit)
+   if (context.depthLimit > settings.min_depth_limit && Timer::Instance().OutOfTime())
    {
-      Timer::Instance().CheckOutOfTime(s_DepthLimit);
+      context.status = SearchContext::OUT_OF_TIME;
    }
-   Pondering::Instance().CheckDonePondering();
+   else if (context.pondering && Pondering::Instance().DonePondering())
+   {
+      context.status = SearchContext::DONE_PONDERING;
+   }
+   else if (context.pStop && *context.pStop)
+   {
+      context.status = SearchContext::HELPER_DONE;
+   }
+   return Stopped(context);
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Check the depth limit, and maybe additional depths if we are
-///           past the normal limit and in a non-quiescent state
+///   @brief  Check to see if the search is stopping. Once it is, every node
+///           returns right away, without using the values it got back.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-bool AiHelper::AtDepthLimit(const MyNode& node)
+bool AiHelper::Stopped(const SearchContext& context)
 {
-   int depth = node.Depth();
-   return (depth >= s_DepthLimit && Quiescent(node.GetAction())) ||
-           depth >= NonQDepthLimit();
+   return context.status != SearchContext::SEARCHING;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  We are considering a quiescent state one where there the last
-///           action did not involve capturing or promoting a pawn
+///   @brief  Get the value of a node with no successors (checkmate or
+///           stalemate for the node's turn player), for the turn player
+///
+////////////////////////////////////////////////////////////////////////////////
+HVal AiHelper::TerminalValue(const MyNode& node)
+{
+   if (node.GetState().InCheck())
+   {
+      return hval::Mated(node.Depth()); // Checkmate (sooner is worse)
+   }
+   return 0; // Stalemate (a draw)
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
 ///
-///           We are not looking for check because it is cheaper to consider
-///           only the action that got us to this state than to evaluate the
-///           state itself
+///   @brief  Check if the node is a draw by repetition (see
+///           SearchContext::Repetition) or the 50 move rule (unless its turn
+///           player was just mated)
 ///
 ////////////////////////////////////////////////////////////////////////////////
-bool AiHelper::Quiescent(const Action& action)
+bool AiHelper::IsDraw(const SearchContext& context, const MyNode& node)
 {
-   return !action.captured && !action.promoted;
+   const State& state = node.GetState();
+   if (state.HalfMoves() >= 100)
+   {
+      return !state.InCheck() || state.NumValidActions() > 0;
+   }
+   return context.Repetition(state.Key(), state.HalfMoves(), node.Depth());
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Get the non-quiescent depth limit
+///   @brief  We are considering a quiescent state one where there the last
+///           action did not involve capturing or promoting a pawn
+///
+///           This only looks at the action (to pick killers). Checks are
+///           found from the board's masks instead (see Extension).
 ///
 ////////////////////////////////////////////////////////////////////////////////
-int AiHelper::NonQDepthLimit()
+bool AiHelper::Quiescent(const Action& action)
 {
-   const Settings& settings = Settings::Instance();
-   return s_DepthLimit + settings.quiescent;
+   return !action.captured && !action.promoted;
 }
 
 
@@ -456,12 +1020,15 @@ int AiHelper::NonQDepthLimit()
 ///   @brief  Print the node's parent action, its successor actions (sorted)
 ///           and the the final choice
 ///
+///           Only called if built with SEARCH_TRACE (cmake -DSEARCH_TRACE=ON),
+///           so the search doesn't sort anything otherwise.
+///
 ////////////////////////////////////////////////////////////////////////////////
-void AiHelper::DebugPrint(const MyNode& node,
-                          const std::map<HVal, std::vector<MyNode*> >& sorted,
-                          const std::pair<HVal, MyNode*>& minmax)
+void AiHelper::DebugPrint(const SearchContext& context, const MyNode& node,
+                          const std::map<HVal, std::vector<Action> >& sorted,
+                          const std::pair<HVal, Action>& best)
 {
-   if (ShouldPrint(node))
+   if (ShouldPrint(context, node))
    {
       // First print the parent action
       if (node.GetParent())
@@ -476,15 +1043,15 @@ void AiHelper::DebugPrint(const MyNode& node,
       // Then the successor actions
       for (auto pair : sorted)
       {
-         for (auto node : pair.second)
+         for (const Action& action : pair.second)
          {
-            debug::PrintAction(node->GetAction(), pair.first);
+            debug::PrintAction(action, pair.first);
          }
       }
       
       // Then the successor that was selected
-      debug::Print(node.Depth() % 2 == 0 ? "max = " : "min = ");
-      debug::PrintAction(minmax.second->GetAction(), minmax.first);
+      debug::Print("best = ");
+      debug::PrintAction(best.second, best.first);
       debug::Print("-------------------------");
    }
 }
@@ -492,18 +1059,18 @@ void AiHelper::DebugPrint(const MyNode& node,
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Only print if verbose and this is the search for the current max
-///           depth limit.
+///   @brief  Only print if verbose and this is the main thread's search for
+///           the current max depth limit.
 ///
 ///           In general we only want to print details for the root and its
 ///           successors, but we make a special exception for very verbose
 ///           mode with a single turn limit.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-bool AiHelper::ShouldPrint(const MyNode& node)
+bool AiHelper::ShouldPrint(const SearchContext& context, const MyNode& node)
 {
    static const Settings& settings = Settings::Instance();
-   if (settings.verbose && s_DepthLimit == settings.max_depth_limit)
+   if (settings.verbose && !context.pStop && context.depthLimit == settings.max_depth_limit)
    {
       if (!node.GetParent()) // Usually just care about the root
       {
@@ -2,9 +2,16 @@
 
 #include "Node.h"
 #include "HeuristicValue.h"
+#include "SearchContext.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <mutex>
 #include <queue>
+#include <thread>
 #include <utility> // std::pair
+#include <vector>
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -18,33 +25,93 @@ class AiHelper
 public:
    static HVal LegacyHeuristic(const MyNode& node);
    static HVal GoodHeuristic(const MyNode& node);
+   static HVal PstHeuristic(const MyNode& node);
    static std::function<HVal(const MyNode&)> s_Heuristic;
    
    static Action Random(const State& state);
-   static Action ID_DL_MiniMax(const State& state, int L = MIN_DEPTH_LIMIT);
+   static Action ID_DL_MiniMax(SearchContext& context, const State& state, int L = MIN_DEPTH_LIMIT);
    
 protected:
    static constexpr int MIN_DEPTH_LIMIT = 1;
+   static constexpr int ASPIRATION_DELTA = 100; // Half the first window (in centipawns)
+   static constexpr int MAX_ASPIRATION_DELTA = 800; // Past this use the full window
+   static constexpr int DELTA_MARGIN = 200; // What a capture could gain besides the piece (in centipawns)
+   static constexpr int NULL_MOVE_MIN_DEPTH = 3; // Plies left to try a null move
+   static constexpr int NULL_MOVE_REDUCTION = 2; // Plies less than a real action (one more when deep)
+   static constexpr int LMR_MIN_DEPTH = 3; // Plies left to reduce late actions
+   static constexpr int LMR_MIN_ACTIONS = 3; // Actions searched in full before any are reduced
+   static constexpr int REDUCTION_DEEP = 6; // Plies left to reduce by one more
+   static constexpr int MAX_EXTENSION_FACTOR = 2; // No extensions past this times the depth limit
+   static constexpr int STABLE_DEPTHS = 3; // Depth limits in a row with the same action to use less time
+   static constexpr double STABLE_SCALE = 0.5; // Of the soft time limit, once the action is stable
+   static constexpr int SCORE_DROP = 50; // From the last depth limit to use more time (in centipawns)
+   static constexpr double SCORE_DROP_SCALE = 2.0; // Of the soft time limit, when the score drops
    
-   static std::pair<HVal, Action> GetMaxAction_Root(MyNode& node, HVal alpha, HVal beta);
-   static std::pair<HVal, Action> GetMaxAction(MyNode& node, HVal alpha, HVal beta);
-   static std::pair<HVal, Action> GetMinAction(MyNode& node, HVal alpha, HVal beta);
+   /////////////////////////////////////////////////////////////////////////////
+   ///
+   ///   @brief  Helper threads for a lazy SMP search. They search the same
+   ///           root as the main thread, each with its own search context,
+   ///           and fill in the shared transposition table for it.
+   ///
+   ///           They are stopped and joined when this goes away.
+   ///
+   /////////////////////////////////////////////////////////////////////////////
+   class HelperThreads
+   {
+   public:
+      HelperThreads(SearchContext& context, const State& state, int numHelpers);
+      HelperThreads(const HelperThreads&) = delete;
+      HelperThreads& operator = (const HelperThreads&) = delete;
+      ~HelperThreads();
+      
+      int TakeResult(std::pair<HVal, Action>& action);
+      
+   protected:
+      static void Run(HelperThreads* pHelpers, int index);
+      void PostResult(int L, const std::pair<HVal, Action>& action);
+      
+      SearchContext& m_Context; // The main thread's
+      const State& m_State;
+      std::vector<uint64_t> m_GameKeys; // Copied before the main thread can change them
+      std::vector<std::thread> m_Threads;
+      std::atomic<bool> m_Stop;
+      std::atomic<uint64_t> m_Nodes;
+      std::mutex m_Mutex; // For the result
+      int m_Depth; // Deepest search a helper has finished
+      std::pair<HVal, Action> m_Action; // The action from that search
+   };
    
-   static HVal GetMaxActionWrapper(MyNode& node, HVal alpha, HVal beta);
-   static HVal GetMinActionWrapper(MyNode& node, HVal alpha, HVal beta);
+   static Action IterativeDeepening(SearchContext& context, HelperThreads& helpers, const State& state, int L);
    
-   static void MaybeQuitEarly();
-   static bool AtDepthLimit(const MyNode& node);
-   static bool Quiescent(const Action& action);
-   static int NonQDepthLimit();
+   static std::pair<HVal, Action> GetBestAction_Aspiration(SearchContext& context, MyNode& node);
+   static std::pair<HVal, Action> GetBestAction_Mate(SearchContext& context, MyNode& node, int moves);
+   static std::pair<HVal, Action> GetBestAction(SearchContext& context, MyNode& node, HVal alpha, HVal beta);
+   static HVal GetBestActionWrapper(SearchContext& context, MyNode& node, HVal alpha, HVal beta);
+   static HVal GetSuccessorValue_PVS(SearchContext& context, MyNode& successor, HVal alpha, HVal beta, bool first,
+                                     int reduction = 0);
+   static bool NullMovePrunes(SearchContext& context, MyNode& node, HVal alpha, HVal beta);
+   static int LateMoveReduction(const SearchContext& context, const MyNode& node, const Successors& successors,
+                                const MyNode& successor, int numSearched, bool inCheck);
+   static int Extension(const SearchContext& context, const MyNode& node, const Successors& successors,
+                        const MyNode& successor, bool inCheck);
+   static HVal Quiesce(SearchContext& context, MyNode& node, HVal alpha, HVal beta);
+   
+   static bool ProbeTable(const SearchContext& context, const MyNode& node, HVal alpha, HVal beta, TranspositionTable::Entry& entry);
+   static void StoreTable(const SearchContext& context, const MyNode& node, HVal alpha, HVal beta, const std::pair<HVal, Action>& best);
+   static void UpdateHistory(SearchContext& context, Action action);
    
-   static void DebugPrint(const MyNode& node,
-                          const std::map<HVal, std::vector<MyNode*> >& sorted,
-                          const std::pair<HVal, MyNode*>& minmax);
-   static bool ShouldPrint(const MyNode& node);
+   static int DepthLeft(const SearchContext& context, const MyNode& node);
+   static bool MateProven(HVal value, int L);
+   static bool StopAfterDepth(SearchContext& context, int L, HVal lastValue, HVal value, double seconds, uint64_t nodes);
+   static bool MaybeQuitEarly(SearchContext& context);
+   static bool Stopped(const SearchContext& context);
+   static HVal TerminalValue(const MyNode& node);
+   static bool IsDraw(const SearchContext& context, const MyNode& node);
+   static bool Quiescent(const Action& action);
    
-   static int s_DepthLimit;
-   static std::pair<HVal, Action> s_BestAction;
-   static std::deque<Action> s_LastTwoMoves;
+   static void DebugPrint(const SearchContext& context, const MyNode& node,
+                          const std::map<HVal, std::vector<Action> >& sorted,
+                          const std::pair<HVal, Action>& best);
+   static bool ShouldPrint(const SearchContext& context, const MyNode& node);
 };
 
@@ -3,7 +3,9 @@
 #include "AiPlayer.h"
 #include "AiHelper.h"
 #include "Pondering.h"
+#include "SearchContext.h"
 #include "Timer.h"
+#include "TranspositionTable.h"
 #include "Settings.h"
 #include "io/Error.h"
 #include "io/Debug.h"
@@ -25,12 +27,19 @@ void AiPlayer::Init()
    static const std::string randomStr    = ""; // get_setting("random");
    static const std::string alphaBStr    = ""; // get_setting("alpha_beta");
    static const std::string htableStr    = ""; // get_setting("history_table");
+   static const std::string pvsStr       = ""; // get_setting("pvs");
    static const std::string ponderingStr = ""; // get_setting("pondering");
    static const std::string sLimitStr    = ""; // get_setting("seconds_limit");
    static const std::string qLimitStr    = ""; // get_setting("quiescent");
+   static const std::string nullMoveStr  = ""; // get_setting("null_move");
+   static const std::string lmrStr       = ""; // get_setting("lmr");
+   static const std::string extendStr    = ""; // get_setting("extensions");
+   static const std::string hashMbStr    = ""; // get_setting("hash_mb");
+   static const std::string threadsStr   = ""; // get_setting("threads");
    static const std::string dLimitStr    = ""; // get_setting("depth_limit");
    static const std::string whichAiStr   = ""; // get_setting("which_ai");
    static const std::string evenOnlyStr  = ""; // get_setting("even_depths_only");
+   static const std::string vHashStr     = ""; // get_setting("verify_hash");
    
    // Initialize settings
    static Settings& settings = Settings::Instance();
@@ -42,11 +51,19 @@ void AiPlayer::Init()
    settings.random           = randomStr.empty()    ?  0 : std::stoi(randomStr);
    settings.alpha_beta       = alphaBStr.empty()    ?  1 : std::stoi(alphaBStr);
    settings.history_table    = htableStr.empty()    ?  1 : std::stoi(htableStr);
+   settings.pvs              = pvsStr.empty()       ?  1 : std::stoi(pvsStr);
    settings.pondering        = ponderingStr.empty() ?  0 : std::stoi(ponderingStr);
    settings.seconds_limit    = sLimitStr.empty()    ? -1 : std::stod(sLimitStr);
-   settings.quiescent        = qLimitStr.empty()    ?  2 : std::stoi(qLimitStr);
+   settings.quiescent        = qLimitStr.empty()    ?  1 : std::stoi(qLimitStr);
+   settings.null_move        = nullMoveStr.empty()  ?  1 : std::stoi(nullMoveStr);
+   settings.lmr              = lmrStr.empty()       ?  1 : std::stoi(lmrStr);
+   settings.extensions       = extendStr.empty()    ?  1 : std::stoi(extendStr);
+   settings.hash_mb          = hashMbStr.empty()    ? 16 : std::stoi(hashMbStr);
+   settings.threads          = threadsStr.empty()   ?  1 : std::stoi(threadsStr);
    settings.max_depth_limit  = dLimitStr.empty()    ?  0 : std::stoi(dLimitStr);
+   settings.mate_moves       = 0; // Only for UCI's 'go mate'
    settings.even_depths_only = evenOnlyStr.empty()  ?  1 : std::stoi(evenOnlyStr);
+   settings.verify_hash      = vHashStr.empty()     ?  0 : std::stoi(vHashStr);
    
    settings.min_depth_limit = 2; // Must exceed this before a move can run out of time
    settings.test = false; // Set to true when unit testing
@@ -55,11 +72,13 @@ void AiPlayer::Init()
    try
    {
      settings.Validate();
+     TranspositionTable::Instance().Resize(settings.hash_mb);
      
      switch(whichAiStr.empty() ? 2 : std::stoi(whichAiStr))
      {
      case 1: AiHelper::s_Heuristic = AiHelper::LegacyHeuristic; break;
      case 2: AiHelper::s_Heuristic = AiHelper::GoodHeuristic; break;
+     case 3: AiHelper::s_Heuristic = AiHelper::PstHeuristic; break;
      default: EXIT("Unknown case"); break;
      }
    }
@@ -92,13 +111,20 @@ void AiPlayer::MyTurn(const std::string& fen, double turn_limit_s)
       settings.seconds_limit = turn_limit_s;
       Timer::Instance().Restart();
       
-      // Pick a move to make
-      Action action = settings.random ? AiHelper::Random(state) : AiHelper::ID_DL_MiniMax(state);
+      // Pick a move to make (keeping the search's history, etc. between turns)
+      static SearchContext context;
+      if (state.HalfMoves() == 0)
+      {
+         context.gameKeys.clear(); // Nothing before a pawn move or capture can repeat
+      }
+      Action action = settings.random ? AiHelper::Random(state) : AiHelper::ID_DL_MiniMax(context, state);
       debug::PrintAction(action);
       
-      // Apply the move
+      // Apply the move (remembering the states for finding repetitions)
+      context.gameKeys.push_back(state.Key());
       state.ApplyAction(action, true);
-      Pondering::Instance().Start(state); // Start pondering
+      context.gameKeys.push_back(state.Key());
+      Pondering::Instance().Start(state, context); // Start pondering (into our context)
    }
    catch (const Error& e)
    {
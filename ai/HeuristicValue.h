@@ -1,27 +1,42 @@
 #pragma once
 
 
-/////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  This struct consolidates heuristic values for the sake of
-///           comparison
+///   @brief  A node's heuristic value in centipawns (with the mobility
+///           folded in as a small weight for each move)
 ///
-/////////////////////////////////////////////////////////////////////////////
-struct HVal
+///           Checkmate values are encoded by how many plies from the root
+///           the mate is, so a quicker mate is worth more. A node reached by
+///           another path (or from another root) can be a different number
+///           of plies from the root, so the transposition table keeps them
+///           by how many plies from the node the mate is instead (see
+///           ToTable / FromTable). Every value fits in 16 bits.
+///
+////////////////////////////////////////////////////////////////////////////////
+typedef int HVal;
+
+namespace hval
+{
+
+constexpr HVal PAWN       = 100;          // Piece values are in pawns
+constexpr HVal MOBILITY   = 1;            // For each move more than the opponent
+constexpr HVal MATE       = 30000;        // Checkmate at the root
+constexpr HVal MATE_BOUND = MATE - 1000;  // Values past this are all mates
+
+constexpr HVal Mated(int ply) { return -MATE + ply; } // For the turn player
+constexpr bool IsMate(HVal value) { return value >= MATE_BOUND || value <= -MATE_BOUND; }
+constexpr int MatePlies(HVal value) { return (value > 0) ? MATE - value : MATE + value; }
+
+// Mates counted from the node (ply plies from the root) instead of the root
+constexpr HVal ToTable(HVal value, int ply)
 {
-   HVal(int val = 0);
-   HVal(int first, int second);
-   HVal& operator = (const HVal& other);
-   bool operator == (const HVal& other) const;
-   bool operator <  (const HVal& other) const;
-   bool operator >  (const HVal& other) const;
-   bool operator != (const HVal& other) const;
-   bool operator <= (const HVal& other) const;
-   bool operator >= (const HVal& other) const;
-   HVal operator *  (const HVal& other) const;
-   HVal operator -  () const;
-   
-   int first;
-   int second;
-};
+   return (value >= MATE_BOUND) ? value + ply : (value <= -MATE_BOUND) ? value - ply : value;
+}
+constexpr HVal FromTable(HVal value, int ply)
+{
+   return (value >= MATE_BOUND) ? value - ply : (value <= -MATE_BOUND) ? value + ply : value;
+}
+
+} // end namespace hval
 
@@ -5,18 +5,6 @@
 #include <cstring>
 
 
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Access the static AI HistoryTable
-///
-////////////////////////////////////////////////////////////////////////////////
-HistoryTable& HistoryTable::Instance()
-{
-   static HistoryTable historyTable;
-   return historyTable;
-}
-
-
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  Reset the history table to all 0s
@@ -15,15 +15,13 @@ struct SimpleAction;
 class HistoryTable
 {
 public:
-   static HistoryTable& Instance();
+   HistoryTable();
    void Reset();
    
    uint64_t& operator[](SimpleAction* pAction);
    const uint64_t& operator[](SimpleAction* pAction) const;
    
 protected:
-   HistoryTable();
-   
    static constexpr int ARRAY_LEN = 64 * 64 * 4;
    uint64_t array[64][64][4]; // 125 KB
 };
@@ -0,0 +1,140 @@
+
+
+#include "MoveList.h"
+#include "HistoryTable.h"
+#include "Settings.h"
+#include "io/Error.h"
+#include <algorithm> // std::swap, std::min
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Constructor (the arrays are only filled as moves are added)
+///
+////////////////////////////////////////////////////////////////////////////////
+MoveList::MoveList()
+   : m_Size(0)
+   , m_Next(0)
+{
+
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Unpack the move at the index into an action. The piece index
+///           is left unknown (the board looks it up when the move is made).
+///
+////////////////////////////////////////////////////////////////////////////////
+Action MoveList::Get(int i) const
+{
+   ASSERT_IN_RANGE(i, 0, m_Size);
+   uint16_t move = m_Moves[i];
+   return Action((move >> START_SHIFT) & 0x3F,
+                 (move >> END_SHIFT) & 0x3F,
+                 Action::UNKNOWN_INDEX,
+                 (move >> PROMOTED_SHIFT) & 0x1,
+                 (move >> PROMO_TYPE_SHIFT) & 0x3);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Find the action in the list
+///
+///   @return  The index of the action, or -1 if it isn't in the list
+///
+////////////////////////////////////////////////////////////////////////////////
+int MoveList::Find(const SimpleAction& action) const
+{
+   uint16_t move = Pack(action.start_pos, action.end_pos, action.promoted, action.promoted_type);
+   for (int i = 0; i < m_Size; ++i)
+   {
+      if (m_Moves[i] == move)
+      {
+         return i;
+      }
+   }
+   return -1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Set the score used to pick the move at the index
+///
+////////////////////////////////////////////////////////////////////////////////
+void MoveList::SetScore(int i, int32_t score)
+{
+   ASSERT_IN_RANGE(i, 0, m_Size);
+   m_Scores[i] = score;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Score every move by its history table count, so the moves
+///           picked most often in earlier searches come first
+///
+///           When unit testing, score by position instead, so the order
+///           doesn't depend on earlier tests.
+///
+////////////////////////////////////////////////////////////////////////////////
+void MoveList::ScoreByHistory(const HistoryTable& historyTable)
+{
+   static const Settings& settings = Settings::Instance();
+   for (int i = 0; i < m_Size; ++i)
+   {
+      Action action = Get(i);
+      if (settings.test)
+      {
+         m_Scores[i] = (action.start_pos << 8) | (action.end_pos << 2) | action.promoted_type;
+      }
+      else
+      {
+         uint64_t history = historyTable[&action];
+         m_Scores[i] = static_cast<int32_t>(std::min<uint64_t>(history, FIRST_SCORE - 1));
+      }
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the best move not picked yet (highest score, or the first
+///           one added if there is a tie)
+///
+///   @return  false if every move has already been picked
+///
+////////////////////////////////////////////////////////////////////////////////
+bool MoveList::Pick(Action& action)
+{
+   if (m_Next >= m_Size)
+   {
+      return false;
+   }
+
+   int best = m_Next;
+   for (int i = m_Next + 1; i < m_Size; ++i)
+   {
+      if (m_Scores[i] > m_Scores[best])
+      {
+         best = i;
+      }
+   }
+
+   // Shift the rest down so ties are still picked in the order added
+   uint16_t bestMove = m_Moves[best];
+   int32_t bestScore = m_Scores[best];
+   for (int i = best; i > m_Next; --i)
+   {
+      m_Moves[i] = m_Moves[i - 1];
+      m_Scores[i] = m_Scores[i - 1];
+   }
+   m_Moves[m_Next] = bestMove;
+   m_Scores[m_Next] = bestScore;
+
+   action = Get(m_Next++);
+   return true;
+}
+
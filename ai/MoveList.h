@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Action.h"
+#include <cstdint>
+
+// forward declaration
+class HistoryTable;
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A fixed-capacity list of moves, kept on the stack so generating
+///           moves never has to allocate
+///
+///           Each move is packed into 16 bits (start pos, end pos, promoted
+///           and promotion type). Scores are kept in a parallel array and
+///           only looked at when moves are picked, best first, with a
+///           selection sort. Most searches cut off after the first few
+///           picks, so most of the list never gets sorted.
+///
+////////////////////////////////////////////////////////////////////////////////
+class MoveList
+{
+public:
+   static constexpr int CAPACITY = 256; // > the most moves possible (218)
+   static constexpr int32_t FIRST_SCORE = INT32_MAX; // Picked before any other
+
+   MoveList();
+
+   void Add(int start_pos, int end_pos, bool promoted = false, int promoted_type = 0);
+   void Clear();
+   int Size() const;
+   bool Empty() const;
+   Action Get(int i) const;
+   int Find(const SimpleAction& action) const;
+
+   void SetScore(int i, int32_t score);
+   void ScoreByHistory(const HistoryTable& historyTable);
+   bool Pick(Action& action);
+
+protected:
+   static constexpr int START_SHIFT      = 0;  // 6 bits
+   static constexpr int END_SHIFT        = 6;  // 6 bits
+   static constexpr int PROMO_TYPE_SHIFT = 12; // 2 bits
+   static constexpr int PROMOTED_SHIFT   = 14; // 1 bit
+
+   static uint16_t Pack(int start_pos, int end_pos, bool promoted, int promoted_type);
+
+   uint16_t m_Moves[CAPACITY];
+   int32_t m_Scores[CAPACITY];
+   int m_Size;
+   int m_Next; // Everything before this has already been picked
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Pack a move into 16 bits
+///
+////////////////////////////////////////////////////////////////////////////////
+inline uint16_t MoveList::Pack(int start_pos, int end_pos, bool promoted, int promoted_type)
+{
+   return (start_pos << START_SHIFT) |
+          (end_pos << END_SHIFT) |
+          (promoted_type << PROMO_TYPE_SHIFT) |
+          (promoted << PROMOTED_SHIFT);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Add a move to the end of the list (with a score of 0)
+///
+////////////////////////////////////////////////////////////////////////////////
+inline void MoveList::Add(int start_pos, int end_pos, bool promoted, int promoted_type)
+{
+   m_Scores[m_Size] = 0;
+   m_Moves[m_Size++] = Pack(start_pos, end_pos, promoted, promoted_type);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Remove all the moves (and forget which were picked)
+///
+////////////////////////////////////////////////////////////////////////////////
+inline void MoveList::Clear()
+{
+   m_Size = 0;
+   m_Next = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the number of moves in the list
+///
+////////////////////////////////////////////////////////////////////////////////
+inline int MoveList::Size() const
+{
+   return m_Size;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Check to see if there are no moves in the list
+///
+////////////////////////////////////////////////////////////////////////////////
+inline bool MoveList::Empty() const
+{
+   return m_Size == 0;
+}
+
@@ -0,0 +1,255 @@
+
+
+#include "MovePicker.h"
+#include "io/Translate.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Constructor (nothing is generated until Next is called)
+///
+///   @param context  The search's killers and history
+///   @param state  Pick actions for this state
+///   @param ply  How deep the state is in the search (for the killers)
+///   @param pHashAction  The best action from the transposition table, if any
+///   @param capturesOnly  Only pick captures and promotions
+///
+////////////////////////////////////////////////////////////////////////////////
+MovePicker::MovePicker(const SearchContext& context, const State& state, int ply, const SimpleAction* pHashAction,
+                       bool capturesOnly)
+   : m_Context(context)
+   , m_State(state)
+   , m_Ply(ply)
+   , m_CapturesOnly(capturesOnly)
+   , m_Stage(HASH_ACTION)
+   , m_Moves()
+   , m_NumPicked(0)
+   , m_NextKiller(0)
+   , m_NumGoodCaptures(0)
+   , m_LosingCapture(false)
+{
+   if (pHashAction)
+   {
+      m_Picked[0] = Action(pHashAction->start_pos, pHashAction->end_pos, Action::UNKNOWN_INDEX,
+                           pHashAction->promoted, pHashAction->promoted_type);
+   }
+   else
+   {
+      m_Stage = GEN_CAPTURES;
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the next action to search
+///
+///   @return  false once every action has been picked
+///
+////////////////////////////////////////////////////////////////////////////////
+bool MovePicker::Next(Action& action)
+{
+   while (true)
+   {
+      switch (m_Stage)
+      {
+         case HASH_ACTION:
+            m_Stage = GEN_CAPTURES;
+            if (IsValid(m_Picked[0]))
+            {
+               action = m_Picked[m_NumPicked++];
+               return true;
+            }
+            break;
+
+         case GEN_CAPTURES:
+            if (m_CapturesOnly)
+            {
+               m_State.GetCaptures(m_Moves);
+            }
+            else
+            {
+               m_State.GetActions(m_Moves, m_State.CaptureMask());
+            }
+            ScoreCaptures();
+            m_Stage = CAPTURES;
+            break;
+
+         case CAPTURES:
+            while ((!m_CapturesOnly || m_NumGoodCaptures > 0) && m_Moves.Pick(action))
+            {
+               m_LosingCapture = (m_NumGoodCaptures-- <= 0);
+               if (!AlreadyPicked(action))
+               {
+                  return true;
+               }
+            }
+            if (m_CapturesOnly)
+            {
+               m_Stage = DONE;
+            }
+            else
+            {
+               m_Stage = (m_Ply < SearchContext::MAX_PLY) ? KILLERS : GEN_QUIETS;
+            }
+            break;
+
+         case KILLERS:
+            while (m_NextKiller < SearchContext::NUM_KILLERS)
+            {
+               const Action& killer = m_Context.killers[m_Ply][m_NextKiller++];
+               bool quiet = !(Translate::PosToMask(killer.end_pos) & m_State.CaptureMask());
+               if (quiet && !AlreadyPicked(killer) && IsValid(killer))
+               {
+                  action = m_Picked[m_NumPicked++] = killer;
+                  return true;
+               }
+            }
+            m_Stage = GEN_QUIETS;
+            break;
+
+         case GEN_QUIETS:
+            m_Moves.Clear();
+            m_State.GetActions(m_Moves, ~m_State.CaptureMask());
+            ScoreQuiets();
+            m_Stage = QUIETS;
+            break;
+
+         case QUIETS:
+            while (m_Moves.Pick(action))
+            {
+               if (!AlreadyPicked(action))
+               {
+                  return true;
+               }
+            }
+            m_Stage = DONE;
+            break;
+
+         default:
+            return false;
+      }
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Check to see if the last action picked came late in the order:
+///           a quiet action (other than the hash action and killers), or a
+///           capture that loses material
+///
+////////////////////////////////////////////////////////////////////////////////
+bool MovePicker::PickedLate() const
+{
+   return (m_Stage == QUIETS) || (m_Stage == CAPTURES && m_LosingCapture);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Check to see if the action is valid for the state
+///
+///           The hash action could be from another state with the same key,
+///           and killers are from other states, so they have to be checked.
+///           Only the actions that move to the same position are generated.
+///
+////////////////////////////////////////////////////////////////////////////////
+bool MovePicker::IsValid(const Action& action) const
+{
+   if (action.start_pos == action.end_pos) // Empty killer slot
+   {
+      return false;
+   }
+   MoveList moves;
+   m_State.GetActions(moves, Translate::PosToMask(action.end_pos));
+   return moves.Find(action) >= 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Check to see if the action was already picked as the hash action
+///           or a killer
+///
+////////////////////////////////////////////////////////////////////////////////
+bool MovePicker::AlreadyPicked(const Action& action) const
+{
+   for (int i = 0; i < m_NumPicked; ++i)
+   {
+      if (m_Picked[i] == action && m_Picked[i].promoted == action.promoted)
+      {
+         return true;
+      }
+   }
+   return false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Score the captures by MVV-LVA: the victim's value (plus the value
+///           gained by promoting) first, then the attacker's value
+///
+///           The king counts as the cheapest attacker, since it can only
+///           capture a piece nothing is guarding. When the attacker is worth
+///           more than its victim (or it promotes), the trade that follows
+///           is played out with SEE, and if it loses material the capture
+///           is scored below every other capture, by how much it loses.
+///
+////////////////////////////////////////////////////////////////////////////////
+void MovePicker::ScoreCaptures()
+{
+   static const int VALUES[NUM_PIECE_TYPES] = {0, 9, 5, 3, 3, 1}; // K, Q, R, B, N, P
+   for (int i = 0; i < m_Moves.Size(); ++i)
+   {
+      Action action = m_Moves.Get(i);
+      PieceType victim = m_State.PieceTypeAt(action.end_pos);
+      PieceType attacker = m_State.PieceTypeAt(action.start_pos);
+      int gained = action.PromotionValueDelta();
+      if (victim != NUM_PIECE_TYPES)
+      {
+         gained += VALUES[victim];
+      }
+      else if (attacker == PAWN && !action.promoted) // En passant (anything else moving there doesn't capture)
+      {
+         gained += VALUES[PAWN];
+      }
+      
+      int see = 0;
+      if (action.promoted || VALUES[attacker] > gained)
+      {
+         see = m_State.See(action);
+      }
+      if (see < 0)
+      {
+         m_Moves.SetScore(i, see * 16 - VALUES[attacker]);
+      }
+      else
+      {
+         m_Moves.SetScore(i, gained * 16 - VALUES[attacker]);
+         ++m_NumGoodCaptures;
+      }
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Score the quiet actions by history, except promoting to a queen,
+///           which goes first
+///
+////////////////////////////////////////////////////////////////////////////////
+void MovePicker::ScoreQuiets()
+{
+   m_Moves.ScoreByHistory(m_Context.history);
+   for (int i = 0; i < m_Moves.Size(); ++i)
+   {
+      Action action = m_Moves.Get(i);
+      if (action.promoted && action.promoted_type == PROMOTED_TO_Q)
+      {
+         m_Moves.SetScore(i, MoveList::FIRST_SCORE);
+      }
+   }
+}
+
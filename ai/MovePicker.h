@@ -0,0 +1,60 @@
+#pragma once
+
+#include "State.h"
+#include "Action.h"
+#include "MoveList.h"
+#include "SearchContext.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Hands out a state's actions one at a time, best guess first,
+///           so a search that cuts off early never has to generate (or
+///           apply) the rest
+///
+///           The actions come in stages:
+///              1. The hash action (the best action the last time this state
+///                 was searched)
+///              2. Captures, most valuable victim first, then least valuable
+///                 attacker first (MVV-LVA), except the ones that lose
+///                 material in the trade that follows (by SEE), which go last
+///              3. Killers (quiet actions that caused a cutoff in a sibling,
+///                 two per ply)
+///              4. Quiet actions, by history table count
+///           Each stage only generates its actions when the stage before it
+///           has been used up.
+///
+///           For a quiescence search, it can stop after the captures (which
+///           then include promotions that don't capture anything), and it
+///           leaves out the ones that lose material.
+///
+////////////////////////////////////////////////////////////////////////////////
+class MovePicker
+{
+public:
+   MovePicker(const SearchContext& context, const State& state, int ply, const SimpleAction* pHashAction = nullptr,
+              bool capturesOnly = false);
+   bool Next(Action& action);
+   bool PickedLate() const;
+
+protected:
+   enum Stage { HASH_ACTION, GEN_CAPTURES, CAPTURES, KILLERS, GEN_QUIETS, QUIETS, DONE };
+
+   bool IsValid(const Action& action) const;
+   bool AlreadyPicked(const Action& action) const;
+   void ScoreCaptures();
+   void ScoreQuiets();
+
+   const SearchContext& m_Context; // For the killers and history
+   const State& m_State;
+   int m_Ply;
+   bool m_CapturesOnly;
+   Stage m_Stage;
+   MoveList m_Moves; // Actions for the current stage
+   Action m_Picked[1 + SearchContext::NUM_KILLERS]; // Hash and killer actions already picked
+   int m_NumPicked;
+   int m_NextKiller;
+   int m_NumGoodCaptures; // Captures that don't lose material (picked first)
+   bool m_LosingCapture; // The last action picked was a capture that loses material
+};
+
@@ -1,8 +1,6 @@
 
 
 #include "Node.h"
-#include "HistoryTable.h"
-#include "Settings.h"
 #include "io/Error.h"
 #include "io/Debug.h"
 
@@ -19,6 +17,8 @@ MyNode::MyNode(const MyNode& other)
    , m_pParent(other.m_pParent)
    , m_Action(other.m_Action)
    , m_Depth(other.m_Depth)
+   , m_Reduction(other.m_Reduction)
+   , m_NullMove(other.m_NullMove)
    , m_MaterialValueDelta(other.m_MaterialValueDelta)
    , m_NumMovesDelta(other.m_NumMovesDelta)
 {
@@ -28,7 +28,10 @@ MyNode::MyNode(const MyNode& other)
 
 ////////////////////////////////////////////////////////////////////////////////
 /// 
-///   @brief  Construct a node that still has its parent's state
+///   @brief  Construct a root node. Its material starts from the state's
+///           balance rather than 0, so a node's value doesn't depend on which
+///           root it was searched from (and the transposition table can keep
+///           it from one move to the next).
 ///        
 ///   @param state  The initial state
 /// 
@@ -38,7 +41,9 @@ MyNode::MyNode(const State& state)
    , m_pParent(NULL)
    , m_Action()
    , m_Depth(0)
-   , m_MaterialValueDelta(0)
+   , m_Reduction(0)
+   , m_NullMove(false)
+   , m_MaterialValueDelta(state.MaterialBalance())
    , m_NumMovesDelta(0)
 {
 
@@ -47,73 +52,77 @@ MyNode::MyNode(const State& state)
 
 ////////////////////////////////////////////////////////////////////////////////
 /// 
-///   @brief  Construct a node that still has its parent's state
-///        
-///   @param state  The parent state
-///   @param parent  A reference to the parent node
-///   @param action  Apply this to the parent state to actuate
+///   @brief  Count the actions that could be applied to the actuated state.
+///           The successor nodes themselves are only made as the search asks
+///           for them (see Successors).
+///
+///           Starts over from the parent's delta, so a node searched again
+///           (e.g. a PVS re-search) isn't counted twice.
+///
+///   @return  The number of successors (0 if the state is terminal)
 /// 
 ////////////////////////////////////////////////////////////////////////////////
-MyNode::MyNode(const State& state, const MyNode* parent, const Action& action)
-   : m_State(state)
-   , m_pParent(parent)
-   , m_Action(action)
-   , m_Depth(parent ? parent->m_Depth + 1: 0)
-   , m_MaterialValueDelta(parent ? parent->m_MaterialValueDelta : 0)
-   , m_NumMovesDelta(parent ? parent->m_NumMovesDelta : 0)
+int MyNode::CountSuccessors()
 {
-   if (m_pParent)
-   {
-      m_MaterialValueDelta += m_State.ApplyAction(m_Action) * Sign();
-   }
+   int numSuccessors = m_State.NumValidActions();
+   m_NumMovesDelta = m_pParent ? m_pParent->m_NumMovesDelta : 0;
+   m_NumMovesDelta += numSuccessors * -Sign(); // Opposite sign for parent
+   return numSuccessors;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 /// 
-///   @brief  Pre-increment operator 
-///           (to update the node's action's history table value)
+///   @brief  Turn this node into the parent's successor for the action. The
+///           action is left made on the state's board (see State::MakeAction).
 /// 
 ////////////////////////////////////////////////////////////////////////////////
-MyNode& MyNode::operator ++()
+void MyNode::MakeSuccessor(const MyNode& parent, const Action& action)
 {
-   static const Settings& settings = Settings::Instance();
-   if (settings.history_table)
-   {
-      ++HistoryTable::Instance()[&m_Action];
-   }
-   return *this;
+   m_State = parent.m_State;
+   m_pParent = &parent;
+   m_Action = action;
+   m_Depth = parent.m_Depth + 1;
+   m_Reduction = parent.m_Reduction;
+   m_NullMove = false;
+   m_MaterialValueDelta = parent.m_MaterialValueDelta;
+   m_NumMovesDelta = parent.m_NumMovesDelta;
+   m_MaterialValueDelta += m_State.MakeAction(m_Action) * Sign();
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 /// 
-///   @brief  Check an actuated state for the actions that could be applied
-///           to it, then construct nodes from those actions
-///                 
-///   @param nodes  Populated with the list of successor nodes
+///   @brief  Turn this node into what the parent's state would be if the
+///           turn player passed (see State::MakeNullAction). It is left made
+///           on the board, so the caller has to take it back.
+///
+///   @param reduction  Plies to search it less deep than a real successor
 /// 
 ////////////////////////////////////////////////////////////////////////////////
-void MyNode::GetSuccessors(std::vector<MyNode>& nodes)
+void MyNode::MakeNullSuccessor(const MyNode& parent, int reduction)
 {
-   std::set<Action, std::greater<Action> > actions;
-   m_State.GetValidActions(actions); // Get actions
-   m_NumMovesDelta += static_cast<int>(actions.size()) * -Sign(); // Opposite sign for parent
-   for (const Action& action : actions) // Create a node for each action
-   {
-      try
-      {
-         nodes.emplace_back(m_State, this, action);
-      }
-      catch (const Error& e)
-      {
-         std::deque<MyNode> parents;
-         BackTrace(parents);
-         for(MyNode& node : parents) { debug::PrintAction(node.GetAction()); }
-         debug::PrintAction(action);
-         debug::Print(e.what());
-      }
-   }
+   m_State = parent.m_State;
+   m_pParent = &parent;
+   m_Action = Action();
+   m_Depth = parent.m_Depth + 1;
+   m_Reduction = parent.m_Reduction + reduction;
+   m_NullMove = true;
+   m_MaterialValueDelta = parent.m_MaterialValueDelta;
+   m_NumMovesDelta = parent.m_NumMovesDelta;
+   m_State.MakeNullAction();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// 
+///   @brief  Search the node (and everything below it) less deep, or deeper
+///           again with a negative number of plies
+/// 
+////////////////////////////////////////////////////////////////////////////////
+void MyNode::Reduce(int plies)
+{
+   m_Reduction += plies;
 }
 
 
@@ -181,13 +190,35 @@ int MyNode::Depth() const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// 
+///   @brief  Get the plies taken off the search along the way to this node
+///
+////////////////////////////////////////////////////////////////////////////////
+int MyNode::Reduction() const
+{
+   return m_Reduction;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// 
+///   @brief  Check to see if the parent passed to get here (a null move)
+///
+////////////////////////////////////////////////////////////////////////////////
+bool MyNode::IsNullMove() const
+{
+   return m_NullMove;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Get the difference in material value before/after the action
-///           was applied for this node
+///   @brief  Get the root player's material balance after the actions down
+///           to this node (the root's balance, plus what the root player
+///           captured and promoted, minus what the opponent did)
 ///
-///   @return  The material value delta (value of captured piece this turn +
-///            new value of promoted piece - 1)
+///   @return  The material value (in pawns)
 ///
 ////////////////////////////////////////////////////////////////////////////////
 int MyNode::MaterialValueDelta() const
@@ -217,3 +248,104 @@ int MyNode::Sign() const
    return (m_Depth % 2 == 0) ? -1 : 1;
 }
 
+
+////////////////////////////////////////////////////////////////////////////////
+/// 
+///   @brief  Constructor (counts the successors, but doesn't make any)
+///
+///   @param context  The search's killers and history (for the order)
+///   @param parent  Make successors of this node
+///   @param pFirst  If this is one of the valid actions, its node goes first
+///   @param capturesOnly  Only make the captures and promotions (uncounted)
+///
+///           If there are no successors (the state is terminal), Size is 0
+///           and Next never makes any.
+/// 
+////////////////////////////////////////////////////////////////////////////////
+Successors::Successors(const SearchContext& context, MyNode& parent, const SimpleAction* pFirst, bool capturesOnly)
+   : m_Parent(parent)
+   , m_Size(capturesOnly ? 0 : parent.CountSuccessors())
+   , m_Picker(context, parent.GetState(), parent.Depth(), pFirst, capturesOnly)
+   , m_Successor(parent) // Made into a successor as they are asked for
+   , m_Made(false)
+{
+   
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// 
+///   @brief  Destructor (takes back the last successor's action, even if the
+///           search is unwinding from an exception)
+/// 
+////////////////////////////////////////////////////////////////////////////////
+Successors::~Successors()
+{
+   if (m_Made)
+   {
+      m_Successor.GetState().UnmakeAction();
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// 
+///   @brief  Get the number of successors
+/// 
+////////////////////////////////////////////////////////////////////////////////
+int Successors::Size() const
+{
+   return m_Size;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// 
+///   @brief  Make the next successor (the last one is taken back first, so it
+///           is no longer valid)
+///
+///   @return  The successor, or nullptr if there are no more
+/// 
+////////////////////////////////////////////////////////////////////////////////
+MyNode* Successors::Next()
+{
+   Unmake();
+   Action action;
+   if (!m_Picker.Next(action))
+   {
+      return nullptr;
+   }
+   m_Successor.MakeSuccessor(m_Parent, action);
+   m_Made = true;
+   return &m_Successor;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// 
+///   @brief  Check to see if the current successor's action was ordered late:
+///           a quiet action past the killers, or a capture that loses
+///           material (see MovePicker::PickedLate)
+/// 
+////////////////////////////////////////////////////////////////////////////////
+bool Successors::Late() const
+{
+   return m_Picker.PickedLate();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// 
+///   @brief  Take back the current successor's action, so the board holds
+///           the parent again
+/// 
+////////////////////////////////////////////////////////////////////////////////
+void Successors::Unmake()
+{
+   if (m_Made)
+   {
+      m_Made = false;
+      ASSERT(m_Successor.GetState().UnmakeAction());
+   }
+}
+
@@ -2,6 +2,7 @@
 
 #include "State.h"
 #include "Action.h"
+#include "MovePicker.h"
 #include <queue>
 #include <vector>
 
@@ -17,26 +18,72 @@ class MyNode
 public:
    explicit MyNode(const MyNode& other);
    explicit MyNode(const State& state);
-   MyNode(const State& state, const MyNode* parent, const Action& action);
-   MyNode& operator ++();
    
-   void GetSuccessors(std::vector<MyNode>& nodes);
+   int CountSuccessors();
+   void MakeNullSuccessor(const MyNode& parent, int reduction);
+   void Reduce(int plies);
    void BackTrace(std::deque<MyNode>& nodes) const;
    
    const State& GetState() const;
    const MyNode* GetParent() const;
    const Action& GetAction() const;
    int Depth() const;
+   int Reduction() const;
+   bool IsNullMove() const;
    int MaterialValueDelta() const;
    int NumMovesDelta() const;
    int Sign() const;
    
 protected:
+   friend class Successors;
+   void MakeSuccessor(const MyNode& parent, const Action& action);
+   
    State       m_State;
    const MyNode* m_pParent;
    Action      m_Action;
    int         m_Depth;
+   int         m_Reduction; // Plies taken off the search below this node
+   bool        m_NullMove; // The parent passed to get here
    int         m_MaterialValueDelta;
    int         m_NumMovesDelta;
 };
 
+
+////////////////////////////////////////////////////////////////////////////////
+/// 
+///   @brief  Makes a node's successors one at a time, as the search asks for
+///           them, so a cutoff after the first one or two never makes the
+///           rest
+///
+///           Each successor's action is left made on the state's board until
+///           the next successor is asked for (or this goes away), so the
+///           successor's own actions come straight from the board.
+///
+///           A quiescence search only makes the captures and promotions.
+///           Those successors aren't counted (counting would generate all
+///           the actions), so Size is 0.
+/// 
+////////////////////////////////////////////////////////////////////////////////
+class Successors
+{
+public:
+   Successors(const SearchContext& context, MyNode& parent, const SimpleAction* pFirst = nullptr,
+              bool capturesOnly = false);
+   Successors(const Successors&) = delete;
+   Successors& operator = (const Successors&) = delete;
+   ~Successors();
+   
+   int Size() const;
+   MyNode* Next();
+   bool Late() const;
+   
+protected:
+   void Unmake();
+   
+   const MyNode& m_Parent;
+   int         m_Size;
+   MovePicker  m_Picker;
+   MyNode      m_Successor;
+   bool        m_Made; // m_Successor's action is made on the board
+};
+
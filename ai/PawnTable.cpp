@@ -0,0 +1,46 @@
+
+
+#include "PawnTable.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Access the calling thread's pawn table
+///
+////////////////////////////////////////////////////////////////////////////////
+PawnTable& PawnTable::Instance()
+{
+   static thread_local PawnTable pawnTable;
+   return pawnTable;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Constructor
+///
+////////////////////////////////////////////////////////////////////////////////
+PawnTable::PawnTable()
+   : m_Entries(NUM_ENTRIES)
+{
+
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the entry for the pawns, working it out from the bit board
+///           (and replacing whatever was in the slot) if it isn't cached
+///
+////////////////////////////////////////////////////////////////////////////////
+const PawnStructure::Entry& PawnTable::Probe(uint64_t pawnKey, const uint8_t* bitBoard)
+{
+   PawnStructure::Entry& entry = m_Entries[pawnKey & (NUM_ENTRIES - 1)];
+   if (entry.key != pawnKey)
+   {
+      PawnStructure::Evaluate(bitBoard, entry);
+      entry.key = pawnKey;
+   }
+   return entry;
+}
+
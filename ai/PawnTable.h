@@ -0,0 +1,34 @@
+#pragma once
+
+#include "board/PawnStructure.h"
+#include <cstdint>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  This table caches the pawn structure terms, keyed by the pawn
+///           key. The pawns only change on a pawn move or capture, so most
+///           leaves of a search hit.
+///
+///           Each search thread has its own table (entries are bigger than
+///           a transposition table slot, and can't be written atomically).
+///           Entries never go stale, so the table is never cleared. An empty
+///           entry is the one for no pawns at all, which is still correct.
+///
+////////////////////////////////////////////////////////////////////////////////
+class PawnTable
+{
+public:
+   static PawnTable& Instance();
+   
+   const PawnStructure::Entry& Probe(uint64_t pawnKey, const uint8_t* bitBoard);
+   
+protected:
+   PawnTable();
+   
+   static constexpr int NUM_ENTRIES = 1 << 14; // A power of 2
+   
+   std::vector<PawnStructure::Entry> m_Entries;
+};
+
@@ -3,7 +3,6 @@
 #include "Pondering.h"
 #include "AiHelper.h"
 #include "Timer.h"
-#include "HistoryTable.h"
 #include "io/Error.h"
 #include "io/Debug.h"
 
@@ -24,8 +23,12 @@ Pondering& Pondering::Instance()
 ///
 ///   @brief  Start the thread
 ///
+///   @param context  The context the search on our turn uses (left alone by
+///                   the caller until Stop), so it starts with the history
+///                   pondering fills in
+///
 ////////////////////////////////////////////////////////////////////////////////
-void Pondering::Start(State& state)
+void Pondering::Start(State& state, SearchContext& context)
 {
    static Settings& settings = Settings::Instance();
    if (settings.pondering && settings.history_table)
@@ -47,11 +50,13 @@ void Pondering::Start(State& state)
       state.SwapTurnPlayer(); // Analyze without the opponent's move
       state.Refresh();
       
-      HistoryTable::Instance().Reset();
+      context.history.Reset();
+      context.pondering = true;
       
       m_Continue = true;
       m_Running = true;
-      m_Thread = std::thread(Run, m_pState = &state); // Start the thread
+      m_pContext = &context;
+      m_Thread = std::thread(Run, m_pContext, m_pState = &state); // Start the thread
    }
 }
 
@@ -72,6 +77,7 @@ void Pondering::Stop()
       
       m_pState->SwapTurnPlayer(); // Reverse previous swap
       m_pState->Refresh();
+      m_pContext->pondering = false;
       
       debug::Print("----------------- Stop pondering");
       
@@ -93,16 +99,13 @@ bool Pondering::Running() const
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  If Pondering::Stop has been called after Pondering::Start,
-///           this method should throw an exception
+///   @brief  Check to see if Pondering::Stop has been called after
+///           Pondering::Start
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void Pondering::CheckDonePondering() const
+bool Pondering::DonePondering() const
 {
-   if (!m_Continue && m_Running)
-   {
-      throw DonePonderingException();
-   }
+   return !m_Continue && m_Running;
 }
 
 
@@ -116,6 +119,7 @@ Pondering::Pondering()
    , m_Running(false)
    , m_Thread()
    , m_pState(nullptr)
+   , m_pContext(nullptr)
    , m_Settings()
 {
    
@@ -128,12 +132,12 @@ Pondering::Pondering()
 ///           pondering
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void Pondering::Run(State* pState)
+void Pondering::Run(SearchContext* pContext, State* pState)
 {
    try
    {
       ASSERT_NE(nullptr, pState);
-      AiHelper::ID_DL_MiniMax(*pState);
+      AiHelper::ID_DL_MiniMax(*pContext, *pState);
    }
    catch (const DonePonderingException&)
    {
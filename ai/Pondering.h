@@ -1,6 +1,7 @@
 #pragma once
 
 #include "State.h"
+#include "SearchContext.h"
 #include "Settings.h"
 
 #include <atomic>
@@ -30,20 +31,21 @@ class Pondering
 public:
    static Pondering& Instance();
    
-   void Start(State& state);
+   void Start(State& state, SearchContext& context);
    void Stop();
    
    bool Running() const;
-   void CheckDonePondering() const;
+   bool DonePondering() const;
    
 protected:
    Pondering();
-   static void Run(State* pState);
+   static void Run(SearchContext* pContext, State* pState);
    
    std::atomic<bool> m_Continue;
    std::atomic<bool> m_Running;
    std::thread m_Thread;
    State* m_pState;
+   SearchContext* m_pContext; // The one our turn's search uses, so it gets what pondering finds
    Settings m_Settings;
 };
 
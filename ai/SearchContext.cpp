@@ -0,0 +1,123 @@
+
+
+#include "SearchContext.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Constructor (nothing searched yet)
+///
+////////////////////////////////////////////////////////////////////////////////
+SearchContext::SearchContext()
+   : board()
+   , history()
+   , killers()
+   , gameKeys()
+   , keys()
+   , depthLimit(0)
+   , bestAction()
+   , rootValue(0)
+   , stableDepths(0)
+   , lastDepthNodes(0)
+   , status(SEARCHING)
+   , pondering(false)
+   , pStop(nullptr)
+   , nodes(0)
+   , onDepth()
+{
+
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Remember a quiet action that caused a cutoff, so it can be tried
+///           early in the other states at the same ply
+///
+////////////////////////////////////////////////////////////////////////////////
+void SearchContext::AddKiller(int ply, const Action& action)
+{
+   if (ply >= MAX_PLY)
+   {
+      return;
+   }
+   Action killer(action.start_pos, action.end_pos, Action::UNKNOWN_INDEX, action.promoted, action.promoted_type);
+   if (!(killers[ply][0] == killer))
+   {
+      killers[ply][1] = killers[ply][0];
+      killers[ply][0] = killer;
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Forget all the killers (e.g. before searching a new root)
+///
+////////////////////////////////////////////////////////////////////////////////
+void SearchContext::ClearKillers()
+{
+   for (int ply = 0; ply < MAX_PLY; ++ply)
+   {
+      for (int i = 0; i < NUM_KILLERS; ++i)
+      {
+         killers[ply][i] = Action();
+      }
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Check if a state repeats one on the stack (a draw). A repeat of
+///           one searched since the root is enough, since the search could
+///           repeat it again; one that was only played before the root has
+///           to have been played twice already (threefold repetition).
+///
+///   @param key  The state's key (not on the stack yet)
+///   @param halfMoves  Since the last pawn move or capture, so no state
+///                     further back could be the same
+///   @param ply  How far the state is below the root
+///
+////////////////////////////////////////////////////////////////////////////////
+bool SearchContext::Repetition(uint64_t key, int halfMoves, int ply) const
+{
+   const int size = static_cast<int>(keys.size());
+   int earlier = 0;
+   for (int back = 2; back <= halfMoves && back <= size; back += 2) // Same turn player
+   {
+      if (keys[size - back] == key)
+      {
+         if (back <= ply || ++earlier == 2)
+         {
+            return true;
+         }
+      }
+   }
+   return false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Push the key (popped when this goes away, even if the search is
+///           unwinding from an exception)
+///
+////////////////////////////////////////////////////////////////////////////////
+SearchContext::KeyGuard::KeyGuard(SearchContext& context, uint64_t key)
+   : m_Context(context)
+{
+   m_Context.keys.push_back(key);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Destructor (pops the key)
+///
+////////////////////////////////////////////////////////////////////////////////
+SearchContext::KeyGuard::~KeyGuard()
+{
+   m_Context.keys.pop_back();
+}
+
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Action.h"
+#include "HeuristicValue.h"
+#include "HistoryTable.h"
+#include "board/Board.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <utility> // std::pair
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Everything a search changes as it goes (other than the shared
+///           transposition table). It is passed down through the search, so
+///           each thread searching has to have its own, and no two searches
+///           get in each other's way.
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SearchContext
+{
+   // Why the search is stopping (if it is)
+   enum Status { SEARCHING, OUT_OF_TIME, DONE_PONDERING, HELPER_DONE };
+
+   static constexpr int MAX_PLY = 128;
+   static constexpr int NUM_KILLERS = 2;
+
+   // Keeps a state's key on the stack while its successors are searched
+   class KeyGuard
+   {
+   public:
+      KeyGuard(SearchContext& context, uint64_t key);
+      KeyGuard(const KeyGuard&) = delete;
+      KeyGuard& operator = (const KeyGuard&) = delete;
+      ~KeyGuard();
+      
+   protected:
+      SearchContext& m_Context;
+   };
+
+   SearchContext();
+   SearchContext(const SearchContext&) = delete;
+   SearchContext& operator = (const SearchContext&) = delete;
+
+   void AddKiller(int ply, const Action& action);
+   void ClearKillers();
+   bool Repetition(uint64_t key, int halfMoves, int ply) const;
+
+   Board board; // The search's states make their moves on this
+   HistoryTable history;
+   Action killers[MAX_PLY][NUM_KILLERS]; // Quiet actions that caused a cutoff
+   std::vector<uint64_t> gameKeys; // The game's states before the root (oldest first), to find repetitions
+   std::vector<uint64_t> keys; // The game's states, then the searched ones down to the current node
+   int depthLimit;
+   std::pair<HVal, Action> bestAction; // From the last depth limit searched
+   HVal rootValue; // From the last depth limit searched (to aim the aspiration window)
+   int stableDepths; // Depth limits in a row that kept the same action (for the time manager)
+   uint64_t lastDepthNodes; // Searched by the last depth limit (for the time manager)
+   Status status;
+   bool pondering; // Searching on the opponent's turn
+   const std::atomic<bool>* pStop; // Only set for a helper thread
+   uint64_t nodes; // Searched (including any helper threads, once done)
+   std::function<void(const SearchContext&)> onDepth; // Called when a depth limit's action is kept (if set)
+};
+
@@ -29,13 +29,21 @@ Settings& Settings::operator = (const Settings& other)
    random           = other.random;
    alpha_beta       = other.alpha_beta;
    history_table    = other.history_table;
+   pvs              = other.pvs;
    pondering        = other.pondering;
    seconds_limit    = other.seconds_limit;
    quiescent        = other.quiescent;
+   null_move        = other.null_move;
+   lmr              = other.lmr;
+   extensions       = other.extensions;
+   hash_mb          = other.hash_mb;
+   threads          = other.threads;
    min_depth_limit  = other.min_depth_limit;
    max_depth_limit  = other.max_depth_limit;
+   mate_moves       = other.mate_moves;
    which_ai         = other.which_ai;
    even_depths_only = other.even_depths_only;
+   verify_hash      = other.verify_hash;
    test             = other.test;
    return *this;
 }
@@ -50,7 +58,10 @@ Settings& Settings::operator = (const Settings& other)
 void Settings::Validate()
 {
    ASSERT_GE(max_depth_limit, 0);
+   ASSERT_GE(mate_moves, 0);
    ASSERT_GE(seconds_limit, -1);
+   ASSERT_GE(hash_mb, 0);
+   ASSERT_GE(threads, 1);
    ASSERT(seconds_limit || test);
 }
 
@@ -20,13 +20,21 @@ struct Settings
    bool random;
    bool alpha_beta;
    bool history_table;
+   bool pvs; // principal variation search (null windows) and aspiration windows
    bool pondering;
    double seconds_limit;
-   int quiescent;
+   bool quiescent; // search captures past the depth limit (quiescence search)
+   bool null_move; // prune when passing still fails high (null-move pruning)
+   bool lmr; // late move reductions (search late quiet and losing actions less deep)
+   bool extensions; // search checks and only replies to check a ply deeper
+   int hash_mb; // transposition table size (0 to turn it off)
+   int threads; // search threads (all share the transposition table)
    int min_depth_limit;
    int max_depth_limit;
+   int mate_moves; // only search for a mate in this many moves (0 for a normal search)
    int which_ai;
    bool even_depths_only;
+   bool verify_hash; // check incremental hash keys against a full recompute
    bool test; // set only if unit testing
 };
 
@@ -1,13 +1,15 @@
 
 
 #include "State.h"
+#include "PawnTable.h"
 #include "TerminalException.h"
 #include "Settings.h"
+#include "board/Zobrist.h"
 #include "io/Error.h"
 #include "io/Debug.h"
 
 
-Board State::s_Board;
+thread_local Board State::s_Board;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -16,9 +18,15 @@ Board State::s_Board;
 ///
 ////////////////////////////////////////////////////////////////////////////////
 State::State(const std::string& fen, const Parser::Options& options)
-   : m_BitBoard(Parser(fen, options).GetBitBoard())
+   : m_pBoard(&s_Board)
+   , m_BitBoard()
+   , m_Key(0)
+   , m_HalfMoves(0)
 {
-   
+   Parser parser(fen, options);
+   m_BitBoard = parser.GetBitBoard();
+   m_Key = Zobrist::Key(m_BitBoard.array);
+   m_HalfMoves = parser.GetHalfMoves();
 }
 
 
@@ -28,7 +36,26 @@ State::State(const std::string& fen, const Parser::Options& options)
 ///
 ////////////////////////////////////////////////////////////////////////////////
 State::State(const State& other)
-   : m_BitBoard(other.m_BitBoard)
+   : m_pBoard(other.m_pBoard)
+   , m_BitBoard(other.m_BitBoard)
+   , m_Key(other.m_Key)
+   , m_HalfMoves(other.m_HalfMoves)
+{
+   
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Copy the state, but make its moves on another board (e.g. a
+///           search's own board, so other searches can't change it)
+///
+////////////////////////////////////////////////////////////////////////////////
+State::State(const State& other, Board& board)
+   : m_pBoard(&board)
+   , m_BitBoard(other.m_BitBoard)
+   , m_Key(other.m_Key)
+   , m_HalfMoves(other.m_HalfMoves)
 {
    
 }
@@ -40,13 +67,12 @@ State::State(const State& other)
 ///           the list of available actions for all those pieces.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void State::GetValidActions(std::set<Action, std::greater<Action> >& actions) const
+void State::GetValidActions(MoveList& moves) const
 {
-   s_Board.GetPiecesAndMasks(m_BitBoard.array); // Reset s_Board
-   s_Board.GetTurnPlayerMoves(actions);
-   if (actions.empty()) // If no actions, this state is terminal
+   GetBoard().GetTurnPlayerMoves(moves);
+   if (moves.Empty()) // If no actions, this state is terminal
    {
-      if (s_Board.InCheck())
+      if (m_pBoard->InCheck())
       {
          throw CheckmateException();
       }
@@ -58,10 +84,156 @@ void State::GetValidActions(std::set<Action, std::greater<Action> >& actions) co
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get just the actions that move to a position in the target mask
+///           (e.g. CaptureMask). Unlike GetValidActions, an empty list
+///           doesn't mean the state is terminal.
+///
+////////////////////////////////////////////////////////////////////////////////
+void State::GetActions(MoveList& moves, uint64_t targetMask) const
+{
+   GetBoard().GetTurnPlayerMoves(moves, targetMask);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get just the captures and promotions (see GetActions)
+///
+////////////////////////////////////////////////////////////////////////////////
+void State::GetCaptures(MoveList& moves) const
+{
+   GetBoard().GetTurnPlayerCaptures(moves);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Count the valid actions without listing them
+///
+///           Unlike GetValidActions, this doesn't throw for a terminal state
+///           (it is called for every node in the search). If there are no
+///           actions, InCheck tells checkmate from stalemate.
+///
+////////////////////////////////////////////////////////////////////////////////
+int State::NumValidActions() const
+{
+   return GetBoard().MoveCount();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Check to see if the turn player's king is in check
+///
+////////////////////////////////////////////////////////////////////////////////
+bool State::InCheck() const
+{
+   return GetBoard().InCheck();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Check to see if the turn player has any pieces besides pawns and
+///           the king
+///
+////////////////////////////////////////////////////////////////////////////////
+bool State::HasNonPawnMaterial() const
+{
+   return GetBoard().HasNonPawnMaterial();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the turn player's material minus their opponent's (see
+///           Board::MaterialBalance)
+///
+////////////////////////////////////////////////////////////////////////////////
+int State::MaterialBalance() const
+{
+   return GetBoard().MaterialBalance();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the tapered piece-square score for the turn player (kept up
+///           to date by the board), plus the pawn structure (usually cached),
+///           so this is cheap
+///
+////////////////////////////////////////////////////////////////////////////////
+int State::Evaluate() const
+{
+   const Board& board = GetBoard();
+   const uint8_t* bitBoard = board.GetBitBoard().array;
+   const PawnStructure::Entry& pawns = PawnTable::Instance().Probe(board.GetPawnKey(), bitBoard);
+   
+   Pst::Score score = board.GetScore();
+   score.mg += pawns.score.mg + PawnStructure::Shield(pawns, bitBoard);
+   score.eg += pawns.score.eg;
+   
+   int value = Pst::Taper(score);
+   return BlacksTurn() ? -value : value;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Check to see if it is black's turn
+///
+////////////////////////////////////////////////////////////////////////////////
+bool State::BlacksTurn() const
+{
+   return GetBoard().BlacksTurn();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get a mask of the positions the turn player would capture
+///           something by moving to
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t State::CaptureMask() const
+{
+   return GetBoard().CaptureMask();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the type of the piece at the position (NUM_PIECE_TYPES if
+///           there isn't one)
+///
+////////////////////////////////////////////////////////////////////////////////
+PieceType State::PieceTypeAt(int pos) const
+{
+   return GetBoard().GetPieceType(pos);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the material the turn player gains by starting a trade of
+///           captures with the action (see Board::See)
+///
+////////////////////////////////////////////////////////////////////////////////
+int State::See(const Action& action) const
+{
+   return GetBoard().See(action);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  Apply the action to the collection of pieces
 ///
+///           The move is made on the board and then taken back, so the board
+///           still holds this state's parent for the next sibling.
+///
 ///   @return  The material value delta (value of captured piece this turn +
 ///            new value of promoted piece - 1)
 ///
@@ -71,18 +243,13 @@ int State::ApplyAction(Action& action, bool forceRefresh)
    bool unknownIndex = (action.piece_index == Action::UNKNOWN_INDEX);
    
    // Refresh the board pieces?
-   if (unknownIndex || forceRefresh)
-   {
-      s_Board.GetPiecesAndMasks(m_BitBoard.array); // Reset s_Board
-   }
-   
-   // Find the index (if this action wasn't constructed by a Piece)
-   if (unknownIndex)
+   if (forceRefresh)
    {
-      action.piece_index = s_Board.GetPieceIndex(action.start_pos);
+      m_pBoard->SetBitBoard(m_BitBoard); // Reset the board
    }
    
-   int captureVal = s_Board.MovePiece(m_BitBoard.array, action);
+   int valueDelta = MakeAction(action);
+   m_pBoard->UnmakeMove();
    
    // Debug printing...
    static const Settings& settings = Settings::Instance();
@@ -90,15 +257,72 @@ int State::ApplyAction(Action& action, bool forceRefresh)
    if (settings.verbose && ((settings.random && unknownIndex && everyOther) || settings.test))
    {
       if (settings.test) { debug::PrintAction(action); }
-      s_Board.GetPiecesAndMasks(m_BitBoard.array); // Reset s_Board
-      s_Board.PrintPieceMasks();
+      m_pBoard->SetBitBoard(m_BitBoard); // Reset the board
+      m_pBoard->PrintPieceMasks();
    }
    everyOther = !everyOther; // Skip printing when we apply their move
    
+   return valueDelta;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Apply the action, but leave the move made on the board (until
+///           UnmakeAction), so the new state's actions can be generated
+///           without resetting the board
+///
+///   @return  The material value delta (see ApplyAction)
+///
+////////////////////////////////////////////////////////////////////////////////
+int State::MakeAction(Action& action)
+{
+   GetBoard(); // Make sure the board holds this state
+   bool pawnMove = (m_pBoard->GetPieceType(action.start_pos) == PAWN);
+   int captureVal = m_pBoard->MakeMove(action);
+   m_BitBoard = m_pBoard->GetBitBoard();
+   m_Key = m_pBoard->GetKey();
+   m_HalfMoves = (pawnMove || captureVal != 0) ? 0 : m_HalfMoves + 1;
    return captureVal + action.PromotionValueDelta();
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Pass the turn without moving (see Board::MakeNullMove), leaving
+///           it made on the board until UnmakeAction
+///
+////////////////////////////////////////////////////////////////////////////////
+void State::MakeNullAction()
+{
+   GetBoard(); // Make sure the board holds this state
+   m_pBoard->MakeNullMove();
+   m_BitBoard = m_pBoard->GetBitBoard();
+   m_Key = m_pBoard->GetKey();
+   m_HalfMoves = 0; // No repetition can reach back past the pass
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Take back the move MakeAction left on the board. This state keeps
+///           the action applied; only the board goes back to the parent.
+///
+///   @return  false if the board was reset to some other state since, so there
+///            was nothing to take back
+///
+////////////////////////////////////////////////////////////////////////////////
+bool State::UnmakeAction() const
+{
+   if (!(m_pBoard->GetBitBoard() == m_BitBoard) || m_pBoard->NumMovesMade() == 0)
+   {
+      return false;
+   }
+   m_pBoard->UnmakeMove();
+   return true;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  Swap white/black as the turn player
@@ -106,7 +330,44 @@ int State::ApplyAction(Action& action, bool forceRefresh)
 ////////////////////////////////////////////////////////////////////////////////
 void State::SwapTurnPlayer()
 {
-   s_Board.SwapTurnPlayer(m_BitBoard.array);
+   m_pBoard->SwapTurnPlayer(m_BitBoard.array, m_Key);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the Zobrist key that identifies this state
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t State::Key() const
+{
+   return m_Key;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the half moves since the last pawn move or capture
+///
+////////////////////////////////////////////////////////////////////////////////
+int State::HalfMoves() const
+{
+   return m_HalfMoves;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the board, reset to this state if it holds another
+///
+////////////////////////////////////////////////////////////////////////////////
+const Board& State::GetBoard() const
+{
+   if (!(m_pBoard->GetBitBoard() == m_BitBoard))
+   {
+      m_pBoard->SetBitBoard(m_BitBoard); // Reset the board
+   }
+   return *m_pBoard;
 }
 
 
@@ -119,8 +380,11 @@ void State::Refresh(const std::string& fen)
 {
    if (!fen.empty())
    {
-      m_BitBoard = Parser(fen).GetBitBoard();
+      Parser parser(fen);
+      m_BitBoard = parser.GetBitBoard();
+      m_Key = Zobrist::Key(m_BitBoard.array);
+      m_HalfMoves = parser.GetHalfMoves();
    }
-   s_Board.GetPiecesAndMasks(m_BitBoard.array); // Reset s_Board
+   m_pBoard->SetBitBoard(m_BitBoard); // Reset the board
 }
 
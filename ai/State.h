@@ -4,8 +4,8 @@
 #include "io/Parser.h"
 #include "board/BitBoard.h"
 #include "Action.h"
+#include "MoveList.h"
 #include <string>
-#include <set>
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -19,14 +19,36 @@ class State
 public:
    State(const std::string& fen, const Parser::Options& options = Parser::Options());
    explicit State(const State& other);
+   State(const State& other, Board& board);
    
-   void GetValidActions(std::set<Action, std::greater<Action> >& actions) const;
+   void GetValidActions(MoveList& moves) const;
+   void GetActions(MoveList& moves, uint64_t targetMask) const;
+   void GetCaptures(MoveList& moves) const;
+   int NumValidActions() const;
+   bool InCheck() const;
+   bool HasNonPawnMaterial() const;
+   int MaterialBalance() const;
+   int Evaluate() const;
+   bool BlacksTurn() const;
+   uint64_t CaptureMask() const;
+   PieceType PieceTypeAt(int pos) const;
+   int See(const Action& action) const;
    int ApplyAction(Action& action, bool forceRefresh = false);
+   int MakeAction(Action& action);
+   void MakeNullAction();
+   bool UnmakeAction() const;
    void SwapTurnPlayer();
+   uint64_t Key() const;
+   int HalfMoves() const;
    void Refresh(const std::string& fen = "");
    
 protected:
-   static Board s_Board;
+   const Board& GetBoard() const;
+   
+   static thread_local Board s_Board; // For states not given a board
+   Board* m_pBoard; // Moves are made and generated on this
    BitBoard m_BitBoard;
+   uint64_t m_Key; // Zobrist key for the bit board
+   int m_HalfMoves; // Since the last pawn move or capture (for the 50 move rule)
 };
 
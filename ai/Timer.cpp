@@ -4,6 +4,10 @@
 #include "Settings.h"
 #include "io/Error.h"
 #include "io/Debug.h"
+#include <algorithm> // std::min, std::max
+
+
+constexpr double Timer::MIN_SECONDS; // Passed by reference to std::max
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -24,9 +28,10 @@ Timer& Timer::Instance()
 ///
 ////////////////////////////////////////////////////////////////////////////////
 Timer::Timer()
-   : m_SecondsInGame(0.0)
-   , m_SecondsThisTurn(0.0)
+   : m_SoftSeconds(0.0)
+   , m_HardSeconds(0.0)
    , m_Start(std::chrono::steady_clock::now())
+   , m_Stopped(false)
 {
    
 }
@@ -34,57 +39,40 @@ Timer::Timer()
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Reset the start time used in the 'Elapsed' calculation
+///   @brief  Reset the start time used in the 'Elapsed' calculation, and set
+///           this turn's limits
+///
+///           A non-negative seconds limit setting is used as is (for the hard
+///           limit, with no soft limit). Otherwise the remaining time is
+///           split evenly over the moves to go, plus most of the increment,
+///           for the soft limit. The hard limit allows a few times that, when
+///           the search needs it, but never most of what is left.
 ///
 ///   @param remaining_s  Time remaining for the player in seconds
+///   @param increment_s  Time added after each of the player's moves
+///   @param moves_to_go  Until the next time control (0 if sudden death)
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void Timer::Restart(double remaining_s)
+void Timer::Restart(double remaining_s, double increment_s, int moves_to_go)
 {
-   // Initialize the total seconds in the game
-   if (m_SecondsInGame == 0.0)
-   {
-      m_SecondsInGame = remaining_s;
-   }
-   
-   // If there is a positive seconds limit setting, use it as is
-   static Settings& settings = Settings::Instance();
+   static const Settings& settings = Settings::Instance();
    if (settings.seconds_limit >= 0.0)
    {
-      m_SecondsThisTurn = settings.seconds_limit;
+      m_SoftSeconds = 0.0;
+      m_HardSeconds = settings.seconds_limit;
    }
    else
    {
-      // Ignore a negative seconds limit setting and calculate a percent
-      if (remaining_s / m_SecondsInGame > .95)
-      {
-         // For the first 5% of the game, make somewhat fast moves
-         m_SecondsThisTurn = 0.0075 * m_SecondsInGame;
-      }
-      else if (remaining_s / m_SecondsInGame > .6)
-      {
-         // For the next 35% of the game, take our time
-         m_SecondsThisTurn = 0.02 * m_SecondsInGame;
-      }
-      else if (remaining_s / m_SecondsInGame > .2)
-      {
-         // For the middle 40% - 80% of the game, take a little less time
-         m_SecondsThisTurn = 0.01 * m_SecondsInGame;
-      }
-      else if (remaining_s / m_SecondsInGame > .05)
-      {
-         // For the next 80% - 95% of the game, move pretty fast
-         m_SecondsThisTurn = 0.005 * m_SecondsInGame;
-      }
-      else
-      {
-         // For the last 5% of the game, move as soon as we pass a certain depth
-         m_SecondsThisTurn = 0.000001;
-         settings.min_depth_limit = 4; // Should be able to get to this quickly
-      }
+      const double usable = std::max(remaining_s - MOVE_OVERHEAD_S, 0.0);
+      const int movesLeft = (moves_to_go > 0) ? moves_to_go : MOVES_LEFT;
+      m_SoftSeconds = usable / movesLeft + INCREMENT_SHARE * increment_s;
+      m_HardSeconds = std::min(HARD_FACTOR * m_SoftSeconds, MAX_HARD_SHARE * usable);
+      m_HardSeconds = std::max(m_HardSeconds, MIN_SECONDS);
+      m_SoftSeconds = std::min(m_SoftSeconds, m_HardSeconds);
    }
    
    m_Start = std::chrono::steady_clock::now();
+   m_Stopped = false;
 }
 
 
@@ -103,18 +91,51 @@ double Timer::Elapsed() const
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  If elapsed exceeds the limit specified in settings, throw
-///           an exception
+///   @brief  Check to see if elapsed exceeds the hard limit for this turn (or
+///           if the timer was stopped)
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void Timer::CheckOutOfTime(int depth)
+bool Timer::OutOfTime() const
 {
-   if (m_SecondsThisTurn > 0.0)
-   {
-      if (Elapsed() >= m_SecondsThisTurn)
-      {
-         throw OutOfTimeException();
-      }
-   }
+   return m_Stopped || (m_HardSeconds > 0.0 && Elapsed() >= m_HardSeconds);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Check to see if elapsed exceeds the soft limit for this turn
+///
+///   @param scale  Applied to the soft limit (e.g. less than 1 when the best
+///                 action is stable, more when the search is in trouble),
+///                 though it can't go past the hard limit
+///
+////////////////////////////////////////////////////////////////////////////////
+bool Timer::PastSoftLimit(double scale) const
+{
+   return m_SoftSeconds > 0.0 && Elapsed() >= std::min(scale * m_SoftSeconds, m_HardSeconds);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Check to see if something taking the seconds (e.g. the next
+///           depth) could finish before the hard limit
+///
+////////////////////////////////////////////////////////////////////////////////
+bool Timer::CanFinish(double seconds) const
+{
+   return m_HardSeconds == 0.0 || Elapsed() + seconds < m_HardSeconds;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Make the search run out of time now (e.g. when told to stop by
+///           another thread)
+///
+////////////////////////////////////////////////////////////////////////////////
+void Timer::Stop()
+{
+   m_Stopped = true;
 }
 
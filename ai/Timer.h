@@ -1,38 +1,40 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
-#include <exception>
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  This exception is raised if we run out of time for the turn
-///
-////////////////////////////////////////////////////////////////////////////////
-class OutOfTimeException : public std::exception
-{
-   
-};
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  This class can is used to measure elapsed time
+///   @brief  This class can is used to measure elapsed time, and to manage
+///           the time for each turn. A search runs out of time at the hard
+///           limit, but should only start another depth before the soft
+///           limit (see PastSoftLimit and CanFinish).
 ///
 ////////////////////////////////////////////////////////////////////////////////
 class Timer
 {
 public:
+   static constexpr int MOVES_LEFT = 30; // Guess when the moves to go aren't given
+   static constexpr double MOVE_OVERHEAD_S = 0.05; // Kept back for sending the move
+   static constexpr double INCREMENT_SHARE = 0.75; // Of the increment to use each turn
+   static constexpr double HARD_FACTOR = 4.0; // Times the soft limit
+   static constexpr double MAX_HARD_SHARE = 0.5; // Of the time remaining
+   static constexpr double MIN_SECONDS = 0.001; // Past the min depth limit, move right away
+   
    static Timer& Instance();
    Timer();
    
-   void Restart(double remaining_s = 0.0);
+   void Restart(double remaining_s = 0.0, double increment_s = 0.0, int moves_to_go = 0);
    double Elapsed() const;
-   void CheckOutOfTime(int depth);
+   bool OutOfTime() const;
+   bool PastSoftLimit(double scale = 1.0) const;
+   bool CanFinish(double seconds) const;
+   void Stop();
    
 protected:
-   double m_SecondsInGame;
-   double m_SecondsThisTurn;
+   double m_SoftSeconds; // Don't start another depth past this (0 if none)
+   double m_HardSeconds; // Stop searching past this (0 if none)
    std::chrono::time_point<std::chrono::steady_clock> m_Start;
+   std::atomic<bool> m_Stopped; // Out of time no matter what (until restarted)
 };
-
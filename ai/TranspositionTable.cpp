@@ -0,0 +1,293 @@
+
+
+#include "TranspositionTable.h"
+#include "Action.h"
+#include "io/Error.h"
+
+
+// Bit layout of a slot's data word
+static constexpr int VALUE_SHIFT      = 0;  // 16 bits, signed (16 more unused)
+static constexpr int START_POS_SHIFT  = 32; // 6 bits
+static constexpr int END_POS_SHIFT    = 38; // 6 bits
+static constexpr int PROMOTED_SHIFT   = 44; // 1 bit
+static constexpr int PROMO_TYPE_SHIFT = 45; // 2 bits
+static constexpr int HAS_ACTION_SHIFT = 47; // 1 bit
+static constexpr int DEPTH_SHIFT      = 48; // 8 bits, signed
+static constexpr int BOUND_SHIFT      = 56; // 2 bits
+static constexpr int GENERATION_SHIFT = 58; // 6 bits
+
+static constexpr uint64_t MASK_2  = 0x3;
+static constexpr uint64_t MASK_6  = 0x3F;
+static constexpr uint64_t MASK_8  = 0xFF;
+static constexpr uint64_t MASK_16 = 0xFFFF;
+
+static constexpr int BYTES_PER_MB = 1024 * 1024;
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Access the static transposition table
+///
+////////////////////////////////////////////////////////////////////////////////
+TranspositionTable& TranspositionTable::Instance()
+{
+   static TranspositionTable transpositionTable;
+   return transpositionTable;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Constructor (the table is empty until it is resized)
+///
+////////////////////////////////////////////////////////////////////////////////
+TranspositionTable::TranspositionTable()
+   : m_Slots()
+   , m_Mask(0)
+   , m_Generation(1) // Zeroed slots are generation 0, so never match
+{
+
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Allocate the biggest power of 2 slots that fit in the size.
+///           A size too small for a bucket turns the table off.
+///
+///           Not safe while another thread is searching.
+///
+////////////////////////////////////////////////////////////////////////////////
+void TranspositionTable::Resize(int megabytes)
+{
+   ASSERT_GE(megabytes, 0);
+
+   uint64_t numSlots = static_cast<uint64_t>(megabytes) * BYTES_PER_MB / sizeof(Slot);
+   while (numSlots & (numSlots - 1)) // Round down to a power of 2
+   {
+      numSlots &= numSlots - 1;
+   }
+
+   if (numSlots < BUCKET_SLOTS)
+   {
+      m_Slots.reset();
+      m_Mask = 0;
+   }
+   else if (numSlots != m_Mask + 1 || !m_Slots)
+   {
+      m_Slots.reset(new Slot[numSlots]);
+      m_Mask = numSlots - 1;
+   }
+   Clear();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Reset every slot to empty
+///
+///           Not safe while another thread is searching.
+///
+////////////////////////////////////////////////////////////////////////////////
+void TranspositionTable::Clear()
+{
+   if (m_Slots)
+   {
+      for (uint64_t i = 0; i <= m_Mask; ++i)
+      {
+         m_Slots[i].keyXorData.store(0, std::memory_order_relaxed);
+         m_Slots[i].data.store(0, std::memory_order_relaxed);
+      }
+   }
+   m_Generation = 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Call before each search, so what the last ones stored is aged
+///           (still found, but replaced first)
+///
+////////////////////////////////////////////////////////////////////////////////
+void TranspositionTable::NewSearch()
+{
+   m_Generation = m_Generation % (GENERATIONS - 1) + 1; // Skip 0 (empty slots)
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Look for the key in the table
+///
+///   @param entry  Populated with the slot's contents if found
+///
+///   @return  true if found
+///
+////////////////////////////////////////////////////////////////////////////////
+bool TranspositionTable::Probe(uint64_t key, Entry& entry) const
+{
+   if (!m_Slots)
+   {
+      return false;
+   }
+
+   const Slot* bucket = Bucket(key);
+   for (uint64_t i = 0; i < BUCKET_SLOTS; ++i)
+   {
+      uint64_t data = 0;
+      if (Holds(bucket[i], key, data))
+      {
+         Unpack(data, entry);
+         return true;
+      }
+   }
+   return false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Store the value for the key. It goes in the bucket's first slot
+///           if that is empty, from an older search, or wasn't searched as
+///           deep. Otherwise it goes in the second slot (unless the first
+///           already has a deeper search of the same key).
+///
+///   @param depth  How many more plies the value was searched to
+///   @param pAction  The best action found (null if none)
+///
+////////////////////////////////////////////////////////////////////////////////
+void TranspositionTable::Store(uint64_t key, int depth, Bound bound, HVal value, const SimpleAction* pAction)
+{
+   if (!m_Slots)
+   {
+      return;
+   }
+
+   // Skip anything that won't fit in the packed data
+   if (value != static_cast<int16_t>(value) || depth != static_cast<int8_t>(depth))
+   {
+      return;
+   }
+
+   Slot* bucket = Bucket(key);
+   Slot* pSlot = &bucket[0];
+   uint64_t oldData = pSlot->data.load(std::memory_order_relaxed);
+   if (Generation(oldData) == m_Generation)
+   {
+      Entry old;
+      Unpack(oldData, old);
+      if (depth < old.depth)
+      {
+         if ((pSlot->keyXorData.load(std::memory_order_relaxed) ^ oldData) == key)
+         {
+            return; // Keep the deeper search
+         }
+         pSlot = &bucket[1];
+      }
+   }
+   Slot& slot = *pSlot;
+
+   uint64_t data = Pack(depth, bound, value, pAction, m_Generation);
+   slot.keyXorData.store(key ^ data, std::memory_order_relaxed);
+   slot.data.store(data, std::memory_order_relaxed);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Pack everything in an entry into a single word
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t TranspositionTable::Pack(int depth, Bound bound, HVal value, const SimpleAction* pAction, uint8_t generation)
+{
+   uint64_t data = 0;
+   data |= (static_cast<uint64_t>(value) & MASK_16) << VALUE_SHIFT;
+   if (pAction)
+   {
+      data |= static_cast<uint64_t>(pAction->start_pos)     << START_POS_SHIFT;
+      data |= static_cast<uint64_t>(pAction->end_pos)       << END_POS_SHIFT;
+      data |= static_cast<uint64_t>(pAction->promoted)      << PROMOTED_SHIFT;
+      data |= static_cast<uint64_t>(pAction->promoted_type) << PROMO_TYPE_SHIFT;
+      data |= 1ULL << HAS_ACTION_SHIFT;
+   }
+   data |= (static_cast<uint64_t>(depth) & MASK_8) << DEPTH_SHIFT;
+   data |= (static_cast<uint64_t>(bound) & MASK_2) << BOUND_SHIFT;
+   data |= (static_cast<uint64_t>(generation) & MASK_6) << GENERATION_SHIFT;
+   return data;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Unpack a slot's data word into an entry
+///
+////////////////////////////////////////////////////////////////////////////////
+void TranspositionTable::Unpack(uint64_t data, Entry& entry)
+{
+   entry.value = static_cast<int16_t>((data >> VALUE_SHIFT) & MASK_16);
+   entry.depth = static_cast<int8_t>((data >> DEPTH_SHIFT) & MASK_8);
+   entry.bound = static_cast<Bound>((data >> BOUND_SHIFT) & MASK_2);
+   entry.hasAction = (data >> HAS_ACTION_SHIFT) & 1;
+   if (entry.hasAction)
+   {
+      entry.action = Action((data >> START_POS_SHIFT) & MASK_6,
+                            (data >> END_POS_SHIFT) & MASK_6,
+                            Action::UNKNOWN_INDEX,
+                            (data >> PROMOTED_SHIFT) & 1,
+                            (data >> PROMO_TYPE_SHIFT) & MASK_2);
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the generation a slot's data word was stored in
+///
+////////////////////////////////////////////////////////////////////////////////
+uint8_t TranspositionTable::Generation(uint64_t data)
+{
+   return (data >> GENERATION_SHIFT) & MASK_6;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Check if the slot holds an entry for the key
+///
+///   @param data  Populated with the slot's data word if it does
+///
+////////////////////////////////////////////////////////////////////////////////
+bool TranspositionTable::Holds(const Slot& slot, uint64_t key, uint64_t& data)
+{
+   uint64_t keyXorData = slot.keyXorData.load(std::memory_order_relaxed);
+   data = slot.data.load(std::memory_order_relaxed);
+   return data != 0 && (keyXorData ^ data) == key; // Empty slots are all 0
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the first slot of the key's bucket
+///
+////////////////////////////////////////////////////////////////////////////////
+TranspositionTable::Slot* TranspositionTable::Bucket(uint64_t key) const
+{
+   return &m_Slots[key & m_Mask & ~(BUCKET_SLOTS - 1)];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Constructor (no action)
+///
+////////////////////////////////////////////////////////////////////////////////
+TranspositionTable::Entry::Entry()
+   : value(0)
+   , depth(0)
+   , bound(NONE)
+   , hasAction(false)
+   , action()
+{
+
+}
+
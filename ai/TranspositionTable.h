@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Action.h"
+#include "HeuristicValue.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  This table caches the values of nodes the search has already
+///           been through, keyed by their Zobrist key. A hit can cut the
+///           search off, or at least say which action to try first.
+///
+///           Each slot is two 64-bit words: the data, and the key XOR-ed with
+///           the data. No locks are needed for threads to share the table.
+///           A slot torn by two threads writing at once just won't match the
+///           key when it is read.
+///
+///           Slots come in pairs (buckets). The first keeps the deepest
+///           search of this generation, and the second takes whatever the
+///           first won't, so a deep entry can't block the bucket.
+///
+///           Node values don't depend on the root, so entries are kept from
+///           one search to the next. Each search bumps the generation, and
+///           entries from older generations are the first to be replaced.
+///
+////////////////////////////////////////////////////////////////////////////////
+class TranspositionTable
+{
+public:
+   enum Bound { NONE, EXACT, LOWER, UPPER };
+
+   // Unpacked contents of a slot
+   struct Entry
+   {
+      Entry();
+      HVal value;
+      int depth;
+      Bound bound;
+      bool hasAction;
+      Action action; // Best action (piece index unknown)
+   };
+
+   static TranspositionTable& Instance();
+   void Resize(int megabytes);
+   void Clear();
+   void NewSearch();
+
+   bool Probe(uint64_t key, Entry& entry) const;
+   void Store(uint64_t key, int depth, Bound bound, HVal value, const SimpleAction* pAction);
+
+protected:
+   TranspositionTable();
+
+   /////////////////////////////////////////////////////////////////////////////
+   ///
+   ///   @brief  One slot in the table (see class description)
+   ///
+   /////////////////////////////////////////////////////////////////////////////
+   struct Slot
+   {
+      std::atomic<uint64_t> keyXorData;
+      std::atomic<uint64_t> data;
+   };
+
+   static uint64_t Pack(int depth, Bound bound, HVal value, const SimpleAction* pAction, uint8_t generation);
+   static void Unpack(uint64_t data, Entry& entry);
+   static uint8_t Generation(uint64_t data);
+   static bool Holds(const Slot& slot, uint64_t key, uint64_t& data);
+
+   static constexpr int GENERATIONS = 64; // Fits in 6 bits
+   static constexpr uint64_t BUCKET_SLOTS = 2; // Deepest, then always replaced
+
+   Slot* Bucket(uint64_t key) const;
+
+   std::unique_ptr<Slot[]> m_Slots;
+   uint64_t m_Mask; // Number of slots - 1 (always a power of 2)
+   uint8_t m_Generation;
+};
+
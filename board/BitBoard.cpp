@@ -63,7 +63,7 @@ BitBoard& BitBoard::operator = (const BitBoard& other)
 ///   @brief  Compare this bit board with another
 ///
 ////////////////////////////////////////////////////////////////////////////////
-bool BitBoard::operator == (const BitBoard& other)
+bool BitBoard::operator == (const BitBoard& other) const
 {
    for (int i = 0; i < BITBOARD_ARRAY_LEN; ++i)
    {
@@ -76,7 +76,7 @@ struct BitBoard
    BitBoard(const uint8_t other[BITBOARD_ARRAY_LEN]);
    BitBoard(const BitBoard& other);
    BitBoard& operator = (const BitBoard& other);
-   bool operator == (const BitBoard& other);
+   bool operator == (const BitBoard& other) const;
    
    uint8_t array[BITBOARD_ARRAY_LEN];
    
@@ -8,12 +8,16 @@
 #include "pieces/Queen.h"
 #include "pieces/Rook.h"
 #include "BitBoard.h"
+#include "Magic.h"
+#include "Zobrist.h"
+#include "ai/Settings.h"
 #include "io/Error.h"
 #include "io/Debug.h"
+#include "io/Translate.h"
+#include <algorithm> // std::fill
 
 
-static constexpr int NUM_R_B_N = 2; // number of rooks/bishops/knights
-static constexpr int NUM_PAWNS = 8;
+constexpr int8_t Board::NO_PIECE; // Passed by reference to std::fill
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -22,12 +26,20 @@ static constexpr int NUM_PAWNS = 8;
 ///
 ////////////////////////////////////////////////////////////////////////////////
 Board::Board()
-   : m_BitBoard(NULL)
-   , m_MyPieces()
-   , m_TheirPieces()
+   : m_BitBoard()
+   , m_Key(0)
+   , m_PawnKey(0)
+   , m_Score()
+   , m_Black()
+   , m_White()
+   , m_MyPieces(&m_White)
+   , m_TheirPieces(&m_Black)
    , m_Masks()
+   , m_MasksValid(false)
+   , m_UndoStack()
 {
-   
+   m_UndoStack.reserve(MAX_MOVES_MADE);
+   SetBitBoard(m_BitBoard);
 }
 
 
@@ -44,65 +56,313 @@ Board::~Board()
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Move the piece specified in the action
+///   @brief  Reset the board to the bit board. Forgets any moves made.
+///
+////////////////////////////////////////////////////////////////////////////////
+void Board::SetBitBoard(const BitBoard& bitBoard)
+{
+   m_BitBoard = bitBoard;
+   m_Key = Zobrist::Key(m_BitBoard.array);
+   m_PawnKey = Zobrist::PawnKey(m_BitBoard.array);
+   m_Score = Pst::Evaluate(m_BitBoard.array);
+   m_UndoStack.clear();
+   m_MasksValid = false;
+   
+   // Position masks and the piece at each position
+   std::fill(m_IndexAt, m_IndexAt + 64, NO_PIECE);
+   m_Black.Clear();
+   m_White.Clear();
+   for (int index = 0; index < NUM_PIECES; ++index)
+   {
+      PieceType type = Piece::GetType(m_BitBoard.array, index);
+      if (type != NUM_PIECE_TYPES)
+      {
+         PlayerPieces& pieces = (index < WHITE_START) ? m_Black : m_White;
+         int pos = Piece::Pos(m_BitBoard.array, index);
+         pieces.byType[type] |= Translate::PosToMask(pos);
+         pieces.pos_mask |= Translate::PosToMask(pos);
+         m_IndexAt[pos] = index;
+      }
+   }
+   
+   SetTurnPlayer();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the bit board for the board's current state
+///
+////////////////////////////////////////////////////////////////////////////////
+const BitBoard& Board::GetBitBoard() const
+{
+   return m_BitBoard;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the Zobrist key for the board's current state
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t Board::GetKey() const
+{
+   return m_Key;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the Zobrist key for the pawns in the board's current state
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t Board::GetPawnKey() const
+{
+   return m_PawnKey;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the piece-square score for the board's current state
+///
+////////////////////////////////////////////////////////////////////////////////
+const Pst::Score& Board::GetScore() const
+{
+   return m_Score;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Move the piece specified in the action, and remember enough to
+///           take the move back with UnmakeMove
 ///
 ///   @return  The value of the captured piece if there was one
 ///
 ////////////////////////////////////////////////////////////////////////////////
-int Board::MovePiece(uint8_t* bitBoard, Action& action)
+int Board::MakeMove(Action& action)
 {
    int capture_val = 0;
    
-   // Get the piece that moved
-   auto piece = m_MyPieces.all[action.piece_index];
+   // Get the piece that moved (look it up if the action didn't say)
+   if (action.piece_index == Action::UNKNOWN_INDEX)
+   {
+      action.piece_index = GetPieceIndex(action.start_pos);
+   }
+   ASSERT_EQ(action.piece_index, m_IndexAt[action.start_pos]);
+   const int index = action.piece_index;
+   const PieceType type = Piece::GetType(m_BitBoard.array, index);
+   const bool black = BlacksTurn();
+   
+   // Save what we need to put everything back
+   Undo& undo = PushUndo();
+   undo.from = action.start_pos;
+   undo.to = action.end_pos;
    
-   // Get a mask for the square that gets captured...
-   uint64_t captureMask = Translate::PosToMask(action.end_pos);
-   if (captureMask == piece->EnPassantMask())
+   // Get the square that gets captured...
+   int capturePos = action.end_pos;
+   if (type == PAWN && Translate::PosToMask(capturePos) == EnPassantMask())
    {
       if (BlacksTurn()) // Moved downward
       {
-         captureMask <<= 1; // So the pawn to capture is above end_pos
+         capturePos += 1; // So the pawn to capture is above end_pos
       }
       else // Moved upward
       {
-         captureMask >>= 1; // So the pawn to capture is below end_pos
+         capturePos -= 1; // So the pawn to capture is below end_pos
       }
    }
    
    // Capture their piece?
-   if (captureMask & m_TheirPieces.pos_mask)
+   int captureIndex = m_IndexAt[capturePos];
+   if (captureIndex != NO_PIECE)
    {
-      for (auto targetPiece : m_TheirPieces.all)
+      ASSERT(m_TheirPieces->pos_mask & Translate::PosToMask(capturePos));
+      PieceType captureType = Piece::GetType(m_BitBoard.array, captureIndex);
+      action.captured = true;
+      capture_val = Piece::Value(captureType);
+      if (captureType == PAWN)
       {
-         if (captureMask == targetPiece.second->PosMask())
-         {
-            action.captured = true;
-            targetPiece.second->SetCaptured(bitBoard);
-            capture_val = targetPiece.second->Value();
-            break;
-         }
+         m_PawnKey ^= Zobrist::PieceKey(m_BitBoard.array, captureIndex);
       }
+      CapturePiece(captureIndex);
+      Pst::Remove(m_Score, !black, captureType, capturePos);
+      m_TheirPieces->byType[captureType] &= ~Translate::PosToMask(capturePos);
+      m_TheirPieces->pos_mask &= ~Translate::PosToMask(capturePos);
+      m_IndexAt[capturePos] = NO_PIECE;
+      undo.capturePos = capturePos;
+      undo.captureIndex = captureIndex;
       ASSERT_GT(capture_val, 0);
    }
    
-   // Move my piece
-   piece->Move(bitBoard, action);
+   // Move my piece (the king moves a rook too if it castles)
+   int rookIndex = (action.end_pos < action.start_pos) ? R1_INDEX : R2_INDEX;
+   rookIndex += (BlacksTurn() ? BLACK_START : WHITE_START);
+   int rookFrom = m_BitBoard.array[rookIndex] >> POS_BITSHIFT;
+   
+   if (type == PAWN)
+   {
+      m_PawnKey ^= Zobrist::PieceKey(m_BitBoard.array, index);
+   }
+   MovePiece(index, action);
+   MovePos(*m_MyPieces, type, action.start_pos, action.end_pos);
+   const PieceType endType = Piece::GetType(m_BitBoard.array, index);
+   if (endType == PAWN) // Not if it was promoted
+   {
+      m_PawnKey ^= Zobrist::PieceKey(m_BitBoard.array, index);
+   }
+   if (action.promoted)
+   {
+      m_MyPieces->byType[type] &= ~Translate::PosToMask(action.end_pos);
+      m_MyPieces->byType[endType] |= Translate::PosToMask(action.end_pos);
+   }
+   Pst::Remove(m_Score, black, type, action.start_pos);
+   Pst::Add(m_Score, black, endType, action.end_pos);
+   
+   int rookTo = m_BitBoard.array[rookIndex] >> POS_BITSHIFT;
+   if (type == KING && rookFrom != rookTo)
+   {
+      MovePos(*m_MyPieces, ROOK, rookFrom, rookTo);
+      Pst::Remove(m_Score, black, ROOK, rookFrom);
+      Pst::Add(m_Score, black, ROOK, rookTo);
+      undo.rookFrom = rookFrom;
+      undo.rookTo = rookTo;
+   }
    
    // Switch turn player
-   SwapTurnPlayer(bitBoard);
+   SwapTurnPlayer(m_BitBoard.array, m_Key);
+   SetTurnPlayer();
+   m_MasksValid = false;
+   
+   // Make sure the incremental keys and score match (slow)
+   static const Settings& settings = Settings::Instance();
+   if (settings.verify_hash)
+   {
+      ASSERT_EQ(Zobrist::Key(m_BitBoard.array), m_Key);
+      ASSERT_EQ(Zobrist::PawnKey(m_BitBoard.array), m_PawnKey);
+      ASSERT(Pst::Evaluate(m_BitBoard.array) == m_Score);
+   }
    
    return capture_val;
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Pass the turn to the other player without moving anything (a
+///           null move, for the search to see what the other player could do
+///           with a free move). Any en passant capture is gone, as it would
+///           be after a real move. It is taken back with UnmakeMove.
+///
+///           Shouldn't be made in check (the other player could then
+///           capture the king).
+///
+////////////////////////////////////////////////////////////////////////////////
+void Board::MakeNullMove()
+{
+   PushUndo();
+   m_Key ^= Zobrist::EnPassantKey(m_BitBoard.array);
+   m_BitBoard.array[SPECIAL] &= ~EN_PASSANT_MASK;
+   SwapTurnPlayer(m_BitBoard.array, m_Key);
+   SetTurnPlayer();
+   m_MasksValid = false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Take back the last move made with MakeMove (or MakeNullMove)
+///
+////////////////////////////////////////////////////////////////////////////////
+void Board::UnmakeMove()
+{
+   ASSERT(!m_UndoStack.empty());
+   const Undo& undo = m_UndoStack.back();
+   
+   // Put the pieces back where they were
+   if (undo.rookFrom != NO_PIECE)
+   {
+      m_IndexAt[undo.rookFrom] = m_IndexAt[undo.rookTo];
+      m_IndexAt[undo.rookTo] = NO_PIECE;
+   }
+   if (undo.from != NO_PIECE) // Not a null move
+   {
+      m_IndexAt[undo.from] = m_IndexAt[undo.to];
+      m_IndexAt[undo.to] = NO_PIECE;
+   }
+   if (undo.captureIndex != NO_PIECE)
+   {
+      m_IndexAt[undo.capturePos] = undo.captureIndex;
+   }
+   
+   m_BitBoard = undo.bitBoard;
+   m_Key = undo.key;
+   m_PawnKey = undo.pawnKey;
+   m_Score = undo.score;
+   m_Black = undo.black;
+   m_White = undo.white;
+   m_MasksValid = undo.masksValid;
+   if (m_MasksValid)
+   {
+      m_Masks = undo.masks;
+   }
+   SetTurnPlayer();
+   
+   m_UndoStack.pop_back();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Save everything a move could change on the undo stack (with no
+///           pieces moved or captured yet)
+///
+////////////////////////////////////////////////////////////////////////////////
+Board::Undo& Board::PushUndo()
+{
+   m_UndoStack.emplace_back();
+   Undo& undo = m_UndoStack.back();
+   undo.bitBoard = m_BitBoard;
+   undo.key = m_Key;
+   undo.pawnKey = m_PawnKey;
+   undo.score = m_Score;
+   undo.black = m_Black;
+   undo.white = m_White;
+   undo.masksValid = m_MasksValid;
+   if (m_MasksValid)
+   {
+      undo.masks = m_Masks;
+   }
+   undo.from = NO_PIECE;
+   undo.to = NO_PIECE;
+   undo.capturePos = NO_PIECE;
+   undo.captureIndex = NO_PIECE;
+   undo.rookFrom = NO_PIECE;
+   undo.rookTo = NO_PIECE;
+   return undo;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the number of moves that can still be taken back
+///
+////////////////////////////////////////////////////////////////////////////////
+int Board::NumMovesMade() const
+{
+   return m_UndoStack.size();
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  Swap white/black as the turn player
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void Board::SwapTurnPlayer(uint8_t* bitBoard)
+void Board::SwapTurnPlayer(uint8_t* bitBoard, uint64_t& key)
 {
+   key ^= Zobrist::TurnKey();
    if (bitBoard[SPECIAL] & BLACKS_TURN_MASK)
    {
       bitBoard[SPECIAL] &= ~BLACKS_TURN_MASK;
@@ -121,24 +381,56 @@ void Board::SwapTurnPlayer(uint8_t* bitBoard)
 ////////////////////////////////////////////////////////////////////////////////
 bool Board::InCheck() const
 {
-   return m_MyPieces.king->PosMask() & m_Masks.myMasks.theirMoves;
+   if (!m_MasksValid)
+   {
+      UpdateMasks();
+   }
+   return m_MyPieces->byType[KING] & m_Masks.myMasks.theirMoves;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Check to see if the king is in check
+///   @brief  Check to see if the turn player has anything besides pawns and
+///           the king (without them, passing could well be the best move)
+///
+////////////////////////////////////////////////////////////////////////////////
+bool Board::HasNonPawnMaterial() const
+{
+   const uint64_t* byType = m_MyPieces->byType;
+   return byType[QUEEN] | byType[ROOK] | byType[BISHOP] | byType[KNIGHT];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the value of the turn player's pieces minus the value of
+///           theirs (see Piece::Value, so kings don't count)
+///
+////////////////////////////////////////////////////////////////////////////////
+int Board::MaterialBalance() const
+{
+   int balance = 0;
+   for (int type = QUEEN; type < NUM_PIECE_TYPES; ++type)
+   {
+      int count = __builtin_popcountll(m_MyPieces->byType[type]) - __builtin_popcountll(m_TheirPieces->byType[type]);
+      balance += count * Piece::Value(static_cast<PieceType>(type));
+   }
+   return balance;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the index of the turn player's piece at the position
 ///
 ////////////////////////////////////////////////////////////////////////////////
 int Board::GetPieceIndex(int pos) const
 {
-   uint64_t posMask = Translate::PosToMask(pos);
-   for (auto piece : m_MyPieces.all)
+   int index = m_IndexAt[pos];
+   if (index != NO_PIECE && (m_MyPieces->pos_mask & Translate::PosToMask(pos)))
    {
-      if (piece.second->PosMask() == posMask)
-      {
-         return piece.second->Index();
-      }
+      return index;
    }
    debug::Print("-------------------------");
    PrintPieceMasks();
@@ -148,6 +440,161 @@ int Board::GetPieceIndex(int pos) const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the type of the piece (either player's) at the position
+///
+///   @return  The type of piece, or NUM_PIECE_TYPES if there isn't one
+///
+////////////////////////////////////////////////////////////////////////////////
+PieceType Board::GetPieceType(int pos) const
+{
+   int index = m_IndexAt[pos];
+   return (index == NO_PIECE) ? NUM_PIECE_TYPES : Piece::GetType(m_BitBoard.array, index);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get a mask of the positions the turn player would capture
+///           something by moving to (including en passant)
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t Board::CaptureMask() const
+{
+   return m_TheirPieces->pos_mask | EnPassantMask();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get every piece (either player's) attacking the position, as
+///           if only the occupied positions had pieces on them (so pieces
+///           can be taken off to find the sliders behind them)
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t Board::AttackersTo(int pos, uint64_t occupied) const
+{
+   const uint64_t* black = m_Black.byType;
+   const uint64_t* white = m_White.byType;
+   const uint64_t queens = black[QUEEN] | white[QUEEN];
+   return (Magic::PawnAttacks(true, pos) & white[PAWN]) |
+          (Magic::PawnAttacks(false, pos) & black[PAWN]) |
+          (Magic::KnightAttacks(pos) & (black[KNIGHT] | white[KNIGHT])) |
+          (Magic::KingAttacks(pos) & (black[KING] | white[KING])) |
+          (Magic::BishopAttacks(pos, occupied) & (black[BISHOP] | white[BISHOP] | queens)) |
+          (Magic::RookAttacks(pos, occupied) & (black[ROOK] | white[ROOK] | queens));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Static exchange evaluation: what the turn player gains if the
+///           action starts a trade of captures on its end position. Each
+///           player captures with their least valuable piece, and either
+///           can stop once capturing again doesn't pay off.
+///
+///           Pieces lined up behind a capturing piece (x-rays) join in once
+///           it is gone. Pins aren't considered. The action has to be valid.
+///
+///   @return  The material gained (in Piece::Value units, < 0 for a loss)
+///
+////////////////////////////////////////////////////////////////////////////////
+int Board::See(const Action& action) const
+{
+   static constexpr int MAX_SWAPS = NUM_PIECES + 1;
+   static constexpr PieceType LEAST_VALUABLE_FIRST[] = {PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING};
+   
+   const int to = action.end_pos;
+   const uint64_t toMask = Translate::PosToMask(to);
+   const PlayerPieces* players[2] = {m_MyPieces, m_TheirPieces};
+   const uint64_t bishops = m_Black.byType[BISHOP] | m_White.byType[BISHOP] | m_Black.byType[QUEEN] | m_White.byType[QUEEN];
+   const uint64_t rooks = m_Black.byType[ROOK] | m_White.byType[ROOK] | m_Black.byType[QUEEN] | m_White.byType[QUEEN];
+   uint64_t occupied = (m_Black.pos_mask | m_White.pos_mask) & ~Translate::PosToMask(action.start_pos);
+   
+   // What the first capture gets
+   int gain[MAX_SWAPS];
+   PieceType attacker = GetPieceType(action.start_pos);
+   PieceType victim = GetPieceType(to);
+   gain[0] = 0;
+   if (victim != NUM_PIECE_TYPES)
+   {
+      gain[0] = SeeValue(victim);
+   }
+   else if (attacker == PAWN && toMask == EnPassantMask())
+   {
+      gain[0] = Pawn::VALUE;
+      occupied &= ~Translate::PosToMask(BlacksTurn() ? to + 1 : to - 1);
+   }
+   int attackerValue = SeeValue(attacker) + action.PromotionValueDelta();
+   gain[0] += action.PromotionValueDelta();
+   
+   // Then take turns capturing back
+   uint64_t attackers = AttackersTo(to, occupied) & occupied;
+   int player = 1; // Theirs
+   int depth = 0;
+   while (true)
+   {
+      // What the last player to capture has if their piece is taken
+      ++depth;
+      gain[depth] = attackerValue - gain[depth - 1];
+      if (std::max(-gain[depth - 1], gain[depth]) < 0)
+      {
+         break; // Neither player does better by going on
+      }
+      
+      uint64_t playerAttackers = attackers & players[player]->pos_mask;
+      PieceType type = NUM_PIECE_TYPES;
+      for (PieceType leastValuable : LEAST_VALUABLE_FIRST)
+      {
+         if (playerAttackers & players[player]->byType[leastValuable])
+         {
+            type = leastValuable;
+            playerAttackers &= players[player]->byType[leastValuable];
+            break;
+         }
+      }
+      if (type == NUM_PIECE_TYPES || (type == KING && (attackers & players[!player]->pos_mask)))
+      {
+         break; // Nothing left to capture with (the king can't capture into check)
+      }
+      
+      // Take the piece off and look behind it
+      occupied &= ~(playerAttackers & -playerAttackers);
+      if (type == PAWN || type == BISHOP || type == QUEEN)
+      {
+         attackers |= Magic::BishopAttacks(to, occupied) & bishops;
+      }
+      if (type == ROOK || type == QUEEN)
+      {
+         attackers |= Magic::RookAttacks(to, occupied) & rooks;
+      }
+      attackers &= occupied;
+      attackerValue = SeeValue(type);
+      player = !player;
+   }
+   
+   // Each player stops as soon as going on would lose more
+   while (--depth)
+   {
+      gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+   }
+   return gain[0];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get a piece's value for the static exchange evaluation (the
+///           king's is more than everything else put together)
+///
+////////////////////////////////////////////////////////////////////////////////
+int Board::SeeValue(PieceType type)
+{
+   return (type == KING) ? SEE_KING_VALUE : Piece::Value(type);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  Print a mask of all of my pieces side-by side with the
@@ -158,11 +605,11 @@ void Board::PrintPieceMasks() const
 {
    if (BlacksTurn()) // Always print white's pieces first
    {
-      debug::PrintMasks(m_TheirPieces.pos_mask, m_MyPieces.pos_mask, true);
+      debug::PrintMasks(m_TheirPieces->pos_mask, m_MyPieces->pos_mask, true);
    }
    else
    {
-      debug::PrintMasks(m_MyPieces.pos_mask, m_TheirPieces.pos_mask, true);
+      debug::PrintMasks(m_MyPieces->pos_mask, m_TheirPieces->pos_mask, true);
    }
 }
 
@@ -171,72 +618,194 @@ void Board::PrintPieceMasks() const
 ///
 ///   @brief  Get the actions available to the turn player
 ///
+///   @param targetMask  Only get moves to these positions (e.g. CaptureMask
+///                      for just the captures)
+///
+////////////////////////////////////////////////////////////////////////////////
+void Board::GetTurnPlayerMoves(MoveList& moves, uint64_t targetMask) const
+{
+   GenerateMoves(targetMask, moves);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get just the turn player's captures and promotions (for a
+///           quiescence search)
+///
 ////////////////////////////////////////////////////////////////////////////////
-void Board::GetTurnPlayerMoves(std::set<Action, std::greater<Action> >& actions) const
+void Board::GetTurnPlayerCaptures(MoveList& moves) const
 {
-   if (InCheck())
+   // Captures (including the ones that promote)
+   GenerateMoves(CaptureMask(), moves);
+   
+   // Then pawns moving up to an empty last row (rare, so anything else that
+   // can move there is generated and just not kept)
+   static constexpr uint64_t ROW_MASK = 0x0101010101010101ULL;
+   const bool black = BlacksTurn();
+   uint64_t lastRowMask = ROW_MASK << (black ? BOTTOM_ROW : TOP_ROW);
+   uint64_t nextToLastMask = ROW_MASK << (black ? BOTTOM_PAWN_ROW : TOP_PAWN_ROW);
+   if (m_MyPieces->byType[PAWN] & nextToLastMask)
+   {
+      uint64_t emptyMask = ~(m_MyPieces->pos_mask | m_TheirPieces->pos_mask);
+      MoveList pushes;
+      GenerateMoves(lastRowMask & emptyMask, pushes);
+      for (int i = 0; i < pushes.Size(); ++i)
+      {
+         Action action = pushes.Get(i);
+         if (action.promoted)
+         {
+            moves.Add(action.start_pos, action.end_pos, true, action.promoted_type);
+         }
+      }
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Count the actions available to the turn player, without making
+///           a list of them
+///
+////////////////////////////////////////////////////////////////////////////////
+int Board::MoveCount() const
+{
+   MoveCounter counter = {0};
+   GenerateMoves(~0ULL, counter);
+   return counter.count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Add the turn player's moves to the list (or counter)
+///
+///   @param targetMask  Only add moves to these positions
+///
+////////////////////////////////////////////////////////////////////////////////
+template <class Moves>
+void Board::GenerateMoves(uint64_t targetMask, Moves& moves) const
+{
+   if (InCheck()) // Also makes sure the masks are up to date
    {
       // First just grab all the pieces the king can move to
-      uint64_t myKingMoveMask = m_MyPieces.king->MoveMask(m_Masks.myMasks);
-      m_MyPieces.king->GetActions(myKingMoveMask, actions);
+      int myKingPos = Translate::MaskToPos(m_MyPieces->byType[KING]);
+      uint64_t myKingMoveMask = King::MoveMask(myKingPos, m_Masks.myMasks);
+      AddPieceMoves<King>(myKingPos, myKingMoveMask & targetMask, moves);
       
       // If multiple threats, the king has to move
-      ASSERT(!m_Masks.threats.empty());
-      if (m_Masks.threats.size() <= 1)
+      ASSERT_GT(m_Masks.numThreats, 0);
+      if (m_Masks.numThreats <= 1)
       {
-         auto threat = m_Masks.threats.back();
-         uint64_t threatPosMask = threat->PosMask();
+         int threatPos = m_Masks.threats[0];
+         uint64_t threatPosMask = Translate::PosToMask(threatPos);
          
          // Can it be captured?
          static const Piece::MaskOptions skipKingOpt(false, false, false, false, true); // Skip king (already have king actions)
-         for (auto piece : m_MyPieces.all)
+         AddAllMoves(skipKingOpt, threatPosMask & targetMask, moves);
+         if (threatPosMask == EnPassantTargetMask()) // Pawns can also take it en passant
          {
-            if (uint64_t captureMask = piece.second->MoveMask(m_Masks.myMasks, skipKingOpt) & threatPosMask)
-            {
-               DontMoveIntoCheck(piece.second->PosMask(), captureMask);
-               if (captureMask)
-               {
-                  piece.second->GetActions(captureMask, actions);
-               }
-            }
+            AddMoves<Pawn>(skipKingOpt, EnPassantMask() & targetMask, moves);
          }
          
          // Can we put something in its way?
          static const Piece::MaskOptions blockOpt(false, false, true, false, true); // Blockable attack against king
-         if (uint64_t blockableMask = threat->MoveMask(m_Masks.theirMasks, blockOpt))
+         PieceType threatType = Piece::GetType(m_BitBoard.array, m_IndexAt[threatPos]);
+         if (uint64_t blockableMask = Piece::MoveMask(threatType, threatPos, m_Masks.theirMasks, blockOpt) & targetMask)
          {
-            for (auto piece : m_MyPieces.all)
-            {
-               if (uint64_t blockMask = piece.second->MoveMask(m_Masks.myMasks) & blockableMask)
-               {
-                  DontMoveIntoCheck(piece.second->PosMask(), blockMask);
-                  if (blockMask)
-                  {
-                     piece.second->GetActions(blockMask, actions);
-                  }
-               }
-            }
+            AddAllMoves(Piece::MaskOptions(), blockableMask, moves);
          }
       }
    }
    else
    {
       // Check all the pieces for actions
-      for (auto piece : m_MyPieces.all)
+      AddAllMoves(Piece::MaskOptions(), targetMask, moves);
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Push actions for each of my pieces of one type
+///
+///   @param maskOptions  Options for the pieces' move masks
+///   @param targetMask  Only keep moves to these positions
+///
+////////////////////////////////////////////////////////////////////////////////
+template <class P, class Moves>
+void Board::AddMoves(const Piece::MaskOptions& maskOptions, uint64_t targetMask, Moves& moves) const
+{
+   if (!targetMask)
+   {
+      return;
+   }
+   for (uint64_t posMasks = m_MyPieces->byType[P::TYPE]; posMasks; posMasks &= posMasks - 1)
+   {
+      int pos = __builtin_ctzll(posMasks);
+      if (uint64_t moveMask = P::MoveMask(pos, m_Masks.myMasks, maskOptions) & targetMask)
       {
-         if (uint64_t moveMask = piece.second->MoveMask(m_Masks.myMasks))
+         DontMoveIntoCheck(Translate::PosToMask(pos), moveMask);
+         if (P::TYPE == PAWN && (moveMask & m_Masks.myMasks.enPassant) && EnPassantExposesKing(pos))
          {
-            DontMoveIntoCheck(piece.second->PosMask(), moveMask);
-            if (moveMask)
-            {
-               piece.second->GetActions(moveMask, actions);
-            }
+            moveMask &= ~m_Masks.myMasks.enPassant;
+         }
+         if (moveMask)
+         {
+            AddPieceMoves<P>(pos, moveMask, moves);
          }
       }
    }
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Push actions for all of my pieces (see AddMoves)
+///
+////////////////////////////////////////////////////////////////////////////////
+template <class Moves>
+void Board::AddAllMoves(const Piece::MaskOptions& maskOptions, uint64_t targetMask, Moves& moves) const
+{
+   AddMoves<King>  (maskOptions, targetMask, moves);
+   AddMoves<Queen> (maskOptions, targetMask, moves);
+   AddMoves<Rook>  (maskOptions, targetMask, moves);
+   AddMoves<Bishop>(maskOptions, targetMask, moves);
+   AddMoves<Knight>(maskOptions, targetMask, moves);
+   AddMoves<Pawn>  (maskOptions, targetMask, moves);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Push an action for every move in the piece's move mask
+///
+////////////////////////////////////////////////////////////////////////////////
+template <class P>
+void Board::AddPieceMoves(int pos, uint64_t moveMask, MoveList& moves)
+{
+   P::AddMoves(pos, moveMask, moves);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Count every move in the piece's move mask (a pawn moving to the
+///           top or bottom row is 4 moves, one per promotion)
+///
+////////////////////////////////////////////////////////////////////////////////
+template <class P>
+void Board::AddPieceMoves(int pos, uint64_t moveMask, MoveCounter& counter)
+{
+   static constexpr uint64_t END_ROWS_MASK = 0x8181818181818181ULL; // TOP_ROW and BOTTOM_ROW
+   counter.count += __builtin_popcountll(moveMask);
+   if (P::TYPE == PAWN)
+   {
+      counter.count += 3 * __builtin_popcountll(moveMask & END_ROWS_MASK);
+   }
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  If the piece's position is in the threat mask, we have to be
@@ -251,11 +820,11 @@ void Board::DontMoveIntoCheck(uint64_t posMask, uint64_t& moveMask) const
 {
    if (posMask & m_Masks.threatsIfMoveMask)
    {
-      for (auto threatMask : m_Masks.threatsIfMove)
+      for (int i = 0; i < m_Masks.numThreatsIfMove; ++i)
       {
-         if (posMask & threatMask)
+         if (posMask & m_Masks.threatsIfMove[i])
          {
-            moveMask &= threatMask;
+            moveMask &= m_Masks.threatsIfMove[i];
          }
       }
    }
@@ -264,16 +833,31 @@ void Board::DontMoveIntoCheck(uint64_t posMask, uint64_t& moveMask) const
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Get all the pieces on the board
+///   @brief  Check to see if my pawn at the position taking en passant would
+///           put my king in check.
+///
+///           The threat masks only see through one of my pieces, but en
+///           passant takes two pawns off the board at once (mine and theirs,
+///           side by side on the same row). Look again for Q/R/B attacks on
+///           my king with both of them gone and my pawn in its new position.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void Board::GetPiecesAndMasks(const uint8_t* bitBoard)
+bool Board::EnPassantExposesKing(int pos) const
 {
-   m_BitBoard = bitBoard;
-   bool blacksTurn = BlacksTurn();
-   GetPieces(blacksTurn ? m_MyPieces : m_TheirPieces, true);
-   GetPieces(blacksTurn ? m_TheirPieces : m_MyPieces, false);
-   GetMasks();
+   uint64_t myKingPosMask = m_MyPieces->byType[KING];
+   if (!myKingPosMask)
+   {
+      return false;
+   }
+   int myKingPos = Translate::MaskToPos(myKingPosMask);
+   
+   uint64_t occupied = m_MyPieces->pos_mask | m_TheirPieces->pos_mask;
+   occupied &= ~Translate::PosToMask(pos) & ~EnPassantTargetMask();
+   occupied |= EnPassantMask();
+   
+   const uint64_t* theirs = m_TheirPieces->byType;
+   return (Magic::RookAttacks(myKingPos, occupied) & (theirs[ROOK] | theirs[QUEEN])) ||
+          (Magic::BishopAttacks(myKingPos, occupied) & (theirs[BISHOP] | theirs[QUEEN]));
 }
 
 
@@ -284,7 +868,46 @@ void Board::GetPiecesAndMasks(const uint8_t* bitBoard)
 ////////////////////////////////////////////////////////////////////////////////
 bool Board::BlacksTurn() const
 {
-   return (m_BitBoard[SPECIAL] & BLACKS_TURN_MASK);
+   return (m_BitBoard.array[SPECIAL] & BLACKS_TURN_MASK);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get a mask for the en passant position (if there is one)
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t Board::EnPassantMask() const
+{
+   const uint8_t special = m_BitBoard.array[SPECIAL];
+   return (special & EN_PASSANT_MASK) ? Translate::PosToMask(special >> POS_BITSHIFT) : 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get a mask for the pawn that could be captured en passant (if
+///           there is one). It is next to the en passant position, on the
+///           side the pawn moved to.
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t Board::EnPassantTargetMask() const
+{
+   uint64_t enPassantMask = EnPassantMask();
+   return BlacksTurn() ? (enPassantMask << 1) : (enPassantMask >> 1);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the castle flags (R1_CASTLE_MASK / R2_CASTLE_MASK) the
+///           player still has
+///
+////////////////////////////////////////////////////////////////////////////////
+uint8_t Board::CastleRights(bool black) const
+{
+   int castleBitshift = black ? BLACK_CASTLE_BITSHIFT : WHITE_CASTLE_BITSHIFT;
+   return (m_BitBoard.array[CASTLE_INDEX] >> castleBitshift) & (R1_CASTLE_MASK | R2_CASTLE_MASK);
 }
 
 
@@ -294,57 +917,126 @@ bool Board::BlacksTurn() const
 ///           move
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void Board::GetMasks()
+void Board::UpdateMasks() const
 {
    m_Masks.Clear();
    
    // Get my king position
-   uint64_t myKingPosMask = m_MyPieces.king->PosMask();
+   uint64_t myKingPosMask = m_MyPieces->byType[KING];
+   
+   bool blacksTurn = BlacksTurn();
+   uint64_t enPassantMask = EnPassantMask();
    
    // Keep theirs simple - just accounting for piece positions
-   m_Masks.theirMasks = Piece::PlayerMasks(m_TheirPieces.pos_mask, m_MyPieces.pos_mask, 0, myKingPosMask, 0);
+   m_Masks.theirMasks = Piece::PlayerMasks(m_TheirPieces->pos_mask, m_MyPieces->pos_mask, 0, myKingPosMask, 0,
+                                           !blacksTurn, enPassantMask, CastleRights(!blacksTurn));
    
    // Consolidate opponent move masks
-   uint64_t theirMoves = 0;
-   for (auto piece : m_TheirPieces.all)
-   {
-      theirMoves |= piece.second->MoveMask(m_Masks.theirMasks);
-   }
+   uint64_t theirMoves = AllMoveMasks(*m_TheirPieces, m_Masks.theirMasks);
    
    // Prep search options...
    static const Piece::MaskOptions firstTwoOpts(true, true); // Guarded pieces, move through my king
    static const Piece::MaskOptions lastTwoOpts(false, false, true, true); // Attacks against king if move through one piece
    
    // Their moves + their guarded pieces + spaces behind my king if Q/R/B on other side
-   uint64_t myKingsDangerSquares = 0;
-   for (auto piece : m_TheirPieces.all)
-   {
-      myKingsDangerSquares |= piece.second->MoveMask(m_Masks.theirMasks, firstTwoOpts);
-   }
+   uint64_t myKingsDangerSquares = AllMoveMasks(*m_TheirPieces, m_Masks.theirMasks, firstTwoOpts);
    
    // My set of masks is more complex - mostly because of check
-   m_Masks.myMasks = Piece::PlayerMasks(m_MyPieces.pos_mask, m_TheirPieces.pos_mask, theirMoves, 0, myKingsDangerSquares);
+   m_Masks.myMasks = Piece::PlayerMasks(m_MyPieces->pos_mask, m_TheirPieces->pos_mask, theirMoves, 0, myKingsDangerSquares,
+                                        blacksTurn, enPassantMask, CastleRights(blacksTurn));
    
-   // Find all the threats to our king if we move a piece
+   // Find all the threats to our king if we move a piece (only Q/R/B can
+   // make a blockable attack)
    m_Masks.threatsIfMoveMask = 0;
-   for (auto piece : m_TheirPieces.all)
+   AddThreatsIfMove<Queen>(lastTwoOpts);
+   AddThreatsIfMove<Rook>(lastTwoOpts);
+   AddThreatsIfMove<Bishop>(lastTwoOpts);
+   
+   // Find all the pieces threatening our king
+   if (myKingPosMask & theirMoves)
+   {
+      AddThreats<King>(myKingPosMask);
+      AddThreats<Queen>(myKingPosMask);
+      AddThreats<Rook>(myKingPosMask);
+      AddThreats<Bishop>(myKingPosMask);
+      AddThreats<Knight>(myKingPosMask);
+      AddThreats<Pawn>(myKingPosMask);
+   }
+   m_MasksValid = true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Combine the move masks for each of the player's pieces of one
+///           type
+///
+////////////////////////////////////////////////////////////////////////////////
+template <class P>
+uint64_t Board::MoveMasks(const PlayerPieces& pieces, const Piece::PlayerMasks& playerMasks, const Piece::MaskOptions& maskOptions)
+{
+   uint64_t moveMask = 0;
+   for (uint64_t posMasks = pieces.byType[P::TYPE]; posMasks; posMasks &= posMasks - 1)
    {
-      if (uint64_t moveMask = piece.second->MoveMask(m_Masks.theirMasks, lastTwoOpts))
+      moveMask |= P::MoveMask(__builtin_ctzll(posMasks), playerMasks, maskOptions);
+   }
+   return moveMask;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Combine the move masks for all of the player's pieces
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t Board::AllMoveMasks(const PlayerPieces& pieces, const Piece::PlayerMasks& playerMasks, const Piece::MaskOptions& maskOptions)
+{
+   return MoveMasks<King>  (pieces, playerMasks, maskOptions) |
+          MoveMasks<Queen> (pieces, playerMasks, maskOptions) |
+          MoveMasks<Rook>  (pieces, playerMasks, maskOptions) |
+          MoveMasks<Bishop>(pieces, playerMasks, maskOptions) |
+          MoveMasks<Knight>(pieces, playerMasks, maskOptions) |
+          MoveMasks<Pawn>  (pieces, playerMasks, maskOptions);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Save the attack each of their pieces of one type would have on
+///           my king if one of my pieces moved out of the way
+///
+////////////////////////////////////////////////////////////////////////////////
+template <class P>
+void Board::AddThreatsIfMove(const Piece::MaskOptions& maskOptions) const
+{
+   for (uint64_t posMasks = m_TheirPieces->byType[P::TYPE]; posMasks; posMasks &= posMasks - 1)
+   {
+      int pos = __builtin_ctzll(posMasks);
+      if (uint64_t moveMask = P::MoveMask(pos, m_Masks.theirMasks, maskOptions))
       {
-         m_Masks.threatsIfMove.push_back(moveMask | piece.second->PosMask());
-         m_Masks.threatsIfMoveMask |= m_Masks.threatsIfMove.back();
+         uint64_t threatMask = moveMask | Translate::PosToMask(pos);
+         m_Masks.threatsIfMove[m_Masks.numThreatsIfMove++] = threatMask;
+         m_Masks.threatsIfMoveMask |= threatMask;
       }
    }
-   
-   // Find all the pieces threatening our king
-   if (InCheck())
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Save the position of each of their pieces of one type that is
+///           attacking my king
+///
+////////////////////////////////////////////////////////////////////////////////
+template <class P>
+void Board::AddThreats(uint64_t myKingPosMask) const
+{
+   for (uint64_t posMasks = m_TheirPieces->byType[P::TYPE]; posMasks; posMasks &= posMasks - 1)
    {
-      for (auto piece : m_TheirPieces.all)
+      int pos = __builtin_ctzll(posMasks);
+      if (P::MoveMask(pos, m_Masks.theirMasks) & myKingPosMask)
       {
-         if (piece.second->MoveMask(m_Masks.theirMasks) & myKingPosMask)
-         {
-            m_Masks.threats.push_back(piece.second);
-         }
+         m_Masks.threats[m_Masks.numThreats++] = pos;
       }
    }
 }
@@ -352,56 +1044,89 @@ void Board::GetMasks()
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Get all the player's pieces on the board
+///   @brief  Point my/their pieces at the right player for the bit board
 ///
-///   @param pieces  Populate this struct of pieces for a particular player
-///   @param black  If true use the indexes in the bit board for black pieces.
-///                 Else use the indexes for white pieces.
+////////////////////////////////////////////////////////////////////////////////
+void Board::SetTurnPlayer()
+{
+   bool blacksTurn = BlacksTurn();
+   m_MyPieces = blacksTurn ? &m_Black : &m_White;
+   m_TheirPieces = blacksTurn ? &m_White : &m_Black;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Update the bit board for the piece at the index moving. The
+///           king, rooks and pawns have more to do than the rest.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void Board::GetPieces(PlayerPieces& pieces, bool black) const
+void Board::MovePiece(int index, const Action& action)
 {
-   pieces.Clear();
-   
-   // King
-   pieces.king = std::make_shared<King>(m_BitBoard, black);
-   pieces.all[pieces.king->Index()] = pieces.king;
-   
-   // Queen
-   std::shared_ptr<Queen> queen = std::make_shared<Queen>(m_BitBoard, black);
-   pieces.all[queen->Index()] = queen;
-   
-   for(int i = 0; i < NUM_R_B_N; ++i)
+   int slot = index % WHITE_START;
+   if (slot == K_INDEX)
    {
-      // Rook
-      std::shared_ptr<Rook> rook = std::make_shared<Rook>(m_BitBoard, black, i);
-      pieces.all[rook->Index()] = rook;
-      
-      // Bishop
-      std::shared_ptr<Bishop> bishop = std::make_shared<Bishop>(m_BitBoard, black, i);
-      pieces.all[bishop->Index()] = bishop;
-      
-      // Knight
-      std::shared_ptr<Knight> knight = std::make_shared<Knight>(m_BitBoard, black, i);
-      pieces.all[knight->Index()] = knight;
+      King::Move(m_BitBoard.array, m_Key, index, action);
    }
-   
-   for(int i = 0; i < NUM_PAWNS; ++i)
+   else if (slot == R1_INDEX || slot == R2_INDEX)
    {
-      // Pawn
-      std::shared_ptr<Pawn> pawn = std::make_shared<Pawn>(m_BitBoard, black, i);
-      pieces.all[pawn->Index()] = pawn;
+      Rook::Move(m_BitBoard.array, m_Key, index, action);
    }
-   
-   // Position mask
-   pieces.pos_mask = 0;
-   for (auto piece : pieces.all)
+   else if (slot % 2) // Pawn (promoted or not)
+   {
+      Pawn::Move(m_BitBoard.array, m_Key, index, action);
+   }
+   else
    {
-      pieces.pos_mask |= piece.second->PosMask();
+      Piece::Move(m_BitBoard.array, m_Key, index, action);
    }
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Update the bit board for the piece at the index being captured
+///
+////////////////////////////////////////////////////////////////////////////////
+void Board::CapturePiece(int index)
+{
+   int slot = index % WHITE_START;
+   if (slot == K_INDEX)
+   {
+      EXIT("King shouldn't be captured");
+   }
+   else if (slot == R1_INDEX || slot == R2_INDEX)
+   {
+      Rook::SetCaptured(m_BitBoard.array, m_Key, index);
+   }
+   else if (slot % 2) // Pawn (promoted or not)
+   {
+      Pawn::SetCaptured(m_BitBoard.array, m_Key, index);
+   }
+   else
+   {
+      Piece::SetCaptured(m_BitBoard.array, m_Key, index);
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Move whatever piece is at 'from' to 'to' in the position masks
+///           and the piece lookup (but not in the bit board)
+///
+////////////////////////////////////////////////////////////////////////////////
+void Board::MovePos(PlayerPieces& pieces, PieceType type, int from, int to)
+{
+   pieces.byType[type] &= ~Translate::PosToMask(from);
+   pieces.byType[type] |= Translate::PosToMask(to);
+   pieces.pos_mask &= ~Translate::PosToMask(from);
+   pieces.pos_mask |= Translate::PosToMask(to);
+   m_IndexAt[to] = m_IndexAt[from];
+   m_IndexAt[from] = NO_PIECE;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  Clear the collection of pieces
@@ -409,8 +1134,7 @@ void Board::GetPieces(PlayerPieces& pieces, bool black) const
 ////////////////////////////////////////////////////////////////////////////////
 void Board::PlayerPieces::Clear()
 {
-   king.reset();
-   all.clear();
+   std::fill(byType, byType + NUM_PIECE_TYPES, 0);
    pos_mask = 0;
 }
 
@@ -424,8 +1148,8 @@ void Board::Masks::Clear()
 {
    myMasks.Clear();
    theirMasks.Clear();
-   threatsIfMove.clear();
+   numThreatsIfMove = 0;
    threatsIfMoveMask = 0;
-   threats.clear();
+   numThreats = 0;
 }
 
@@ -1,10 +1,10 @@
 #pragma once
 
 #include "pieces/Piece.h"
+#include "board/BitBoard.h"
+#include "board/Pst.h"
 #include "ai/Action.h"
-#include <map>
-#include <memory>
-#include <set>
+#include "ai/MoveList.h"
 #include <vector>
 
 
@@ -12,25 +12,58 @@
 ///
 ///   @brief  This class represents the current state of the game
 ///
+///           The board keeps its own copy of the bit board, plus a bit-mask
+///           per piece type for each player. Moves are made and unmade in
+///           place, so walking a search tree never has to rebuild anything
+///           or copy a state per node.
+///
+///           Move generation loops over the bit-masks for each type, with
+///           the piece class picked at compile time (see AddMoves).
+///
 ////////////////////////////////////////////////////////////////////////////////
 class Board
 {
 public:
    Board();
+   Board(const Board&) = delete;
+   Board& operator = (const Board&) = delete;
    virtual ~Board();
-   
-   int MovePiece(uint8_t* bitBoard, Action& action);
-   static void SwapTurnPlayer(uint8_t* bitBoard);
-   
+
+   void SetBitBoard(const BitBoard& bitBoard);
+   const BitBoard& GetBitBoard() const;
+   uint64_t GetKey() const;
+   uint64_t GetPawnKey() const;
+   const Pst::Score& GetScore() const;
+
+   int MakeMove(Action& action);
+   void MakeNullMove();
+   void UnmakeMove();
+   int NumMovesMade() const;
+
+   static void SwapTurnPlayer(uint8_t* bitBoard, uint64_t& key);
+
    bool InCheck() const;
+   bool HasNonPawnMaterial() const;
+   int MaterialBalance() const;
+   bool BlacksTurn() const;
    int GetPieceIndex(int pos) const;
+   PieceType GetPieceType(int pos) const;
+   uint64_t CaptureMask() const;
+   uint64_t AttackersTo(int pos, uint64_t occupied) const;
+   int See(const Action& action) const;
    void PrintPieceMasks() const;
-   
-   void GetTurnPlayerMoves(std::set<Action, std::greater<Action> >& actions) const;
-   void GetPiecesAndMasks(const uint8_t* bitBoard);
-   
+
+   void GetTurnPlayerMoves(MoveList& moves, uint64_t targetMask = ~0ULL) const;
+   void GetTurnPlayerCaptures(MoveList& moves) const;
+   int MoveCount() const;
+
 protected:
-   
+   static constexpr int NUM_PIECES = 32; // Both players
+   static constexpr int MAX_THREATS = NUM_PIECES / 2;
+   static constexpr int8_t NO_PIECE = -1;
+   static constexpr int MAX_MOVES_MADE = 128; // Reserved undo stack depth
+   static constexpr int SEE_KING_VALUE = 100; // It can capture last, but is never captured
+
    /////////////////////////////////////////////////////////////////////////////
    ///
    ///   @brief  Helper class to consolidate storage of pieces for a player
@@ -39,14 +72,14 @@ protected:
    struct PlayerPieces
    {
       void Clear();
-      std::shared_ptr<Piece> king;
-      std::map<int, std::shared_ptr<Piece> > all;
+      uint64_t byType[NUM_PIECE_TYPES]; // position bit-mask for each type
       uint64_t pos_mask; // position bit-mask
    };
-   
+
    /////////////////////////////////////////////////////////////////////////////
    ///
-   ///   @brief  Helper class to store 
+   ///   @brief  Helper class to store the masks / threats the turn player
+   ///           needs to decide how to move
    ///
    /////////////////////////////////////////////////////////////////////////////
    struct Masks
@@ -54,19 +87,85 @@ protected:
       void Clear();
       Piece::PlayerMasks myMasks;
       Piece::PlayerMasks theirMasks;
-      std::vector<uint64_t> threatsIfMove; // Potential threats
+      uint64_t threatsIfMove[MAX_THREATS]; // Potential threats
+      int numThreatsIfMove;
       uint64_t threatsIfMoveMask;
-      std::vector<std::shared_ptr<Piece> > threats; // Active threats
+      int8_t threats[MAX_THREATS]; // Positions of active threats
+      int numThreats;
    };
-   
+
+   /////////////////////////////////////////////////////////////////////////////
+   ///
+   ///   @brief  Everything MakeMove changed that UnmakeMove can't work out
+   ///           from the action alone
+   ///
+   /////////////////////////////////////////////////////////////////////////////
+   struct Undo
+   {
+      BitBoard bitBoard;
+      uint64_t key;
+      uint64_t pawnKey;
+      Pst::Score score;
+      PlayerPieces black;
+      PlayerPieces white;
+      Masks masks;
+      bool masksValid;
+      int8_t from;
+      int8_t to;
+      int8_t capturePos;
+      int8_t captureIndex;
+      int8_t rookFrom; // Set if the king castled
+      int8_t rookTo;
+   };
+
+   /////////////////////////////////////////////////////////////////////////////
+   ///
+   ///   @brief  Stands in for a move list when only the number of moves is
+   ///           needed (see MoveCount)
+   ///
+   /////////////////////////////////////////////////////////////////////////////
+   struct MoveCounter
+   {
+      int count;
+   };
+
+   template <class P> static uint64_t MoveMasks(const PlayerPieces& pieces, const Piece::PlayerMasks& playerMasks, const Piece::MaskOptions& maskOptions);
+   static uint64_t AllMoveMasks(const PlayerPieces& pieces, const Piece::PlayerMasks& playerMasks, const Piece::MaskOptions& maskOptions = Piece::MaskOptions());
+   template <class P> void AddThreatsIfMove(const Piece::MaskOptions& maskOptions) const;
+   template <class P> void AddThreats(uint64_t myKingPosMask) const;
+   template <class Moves> void GenerateMoves(uint64_t targetMask, Moves& moves) const;
+   template <class P, class Moves> void AddMoves(const Piece::MaskOptions& maskOptions, uint64_t targetMask, Moves& moves) const;
+   template <class Moves> void AddAllMoves(const Piece::MaskOptions& maskOptions, uint64_t targetMask, Moves& moves) const;
+   template <class P> static void AddPieceMoves(int pos, uint64_t moveMask, MoveList& moves);
+   template <class P> static void AddPieceMoves(int pos, uint64_t moveMask, MoveCounter& counter);
+
+   Undo& PushUndo();
    void DontMoveIntoCheck(uint64_t posMask, uint64_t& moveMask) const;
-   bool BlacksTurn() const;
-   void GetMasks();
-   void GetPieces(PlayerPieces& pieces, bool black) const;
-   
-   const uint8_t* m_BitBoard; // Set only when GetPiecesAndMasks is called
-   PlayerPieces m_MyPieces;
-   PlayerPieces m_TheirPieces;
-   Masks        m_Masks;
+   uint64_t EnPassantMask() const;
+   uint64_t EnPassantTargetMask() const;
+   bool EnPassantExposesKing(int pos) const;
+   uint8_t CastleRights(bool black) const;
+   static int SeeValue(PieceType type);
+   void UpdateMasks() const;
+   void SetTurnPlayer();
+   void MovePiece(int index, const Action& action);
+   void CapturePiece(int index);
+   void MovePos(PlayerPieces& pieces, PieceType type, int from, int to);
+
+   BitBoard m_BitBoard;
+   uint64_t m_Key; // Zobrist key for the bit board
+   uint64_t m_PawnKey; // Zobrist key for just the pawns
+   Pst::Score m_Score; // Piece-square score for the bit board
+   PlayerPieces m_Black;
+   PlayerPieces m_White;
+   PlayerPieces* m_MyPieces;
+   PlayerPieces* m_TheirPieces;
+   int8_t m_IndexAt[64]; // Index of the piece at each position, or NO_PIECE
+
+   // Only recalculated when the turn player needs them
+   mutable Masks m_Masks;
+   mutable bool m_MasksValid;
+
+   std::vector<Undo> m_UndoStack;
 };
 
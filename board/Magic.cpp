@@ -0,0 +1,233 @@
+
+
+#include "Magic.h"
+#include "io/Error.h"
+
+
+// Directions as {col, row} steps
+static const int ROOK_DIRECTIONS[4][2]   = {{-1, 0}, {1, 0}, {0, 1}, {0, -1}};
+static const int BISHOP_DIRECTIONS[4][2] = {{-1, 1}, {-1, -1}, {1, 1}, {1, -1}};
+
+// Magic multipliers for each position (found once by trying sparse random
+// numbers, and checked against every occupancy by MagicTester), so startup
+// only has to fill the tables
+const uint64_t Magic::ROOK_MAGICS[64] = {
+   0x3080004004603088ULL, 0x8080200082400094ULL, 0x0280200008100080ULL, 0x8180048008011000ULL,
+   0x0100080010050002ULL, 0x020008A110120004ULL, 0x9100010004288200ULL, 0x2100010000218052ULL,
+   0x0000800080B44004ULL, 0x2A09002302400184ULL, 0x0009001102A00040ULL, 0x0001002090040900ULL,
+   0x0008800400880080ULL, 0x080A001014884200ULL, 0x0424001A30040948ULL, 0x040100008061000AULL,
+   0x1040018000204880ULL, 0xD005404000201000ULL, 0x0007050040200050ULL, 0x000122000A001040ULL,
+   0x0806020010201804ULL, 0xC102808042001400ULL, 0x02401C0002080110ULL, 0x0020020021004484ULL,
+   0x4009C00080008020ULL, 0x0011008500400960ULL, 0x004500C300102000ULL, 0x8490008080280050ULL,
+   0x0050840080800800ULL, 0x0004040080800200ULL, 0x2000888400021001ULL, 0x2018848200004421ULL,
+   0x0000804000800832ULL, 0x0030042018400040ULL, 0x8024423202002382ULL, 0x3051100081802800ULL,
+   0x4006640080804800ULL, 0x000D802A00802400ULL, 0x0041080224008910ULL, 0x0812440082003041ULL,
+   0x0100884016608000ULL, 0x4060004000828028ULL, 0x08A0030210410020ULL, 0x0000080010008080ULL,
+   0x8108048801010010ULL, 0x008A001804220010ULL, 0x0020C81E41340050ULL, 0x9000040040920001ULL,
+   0x60800420014011C0ULL, 0x0200C30208208200ULL, 0x2604116005410100ULL, 0x0880300080080080ULL,
+   0x8200040058008180ULL, 0x01000400803A0080ULL, 0x100801104208A400ULL, 0x0001000140820300ULL,
+   0x2108104900800061ULL, 0x000420C002110289ULL, 0x04CA9A0280401022ULL, 0x0200890430010021ULL,
+   0x0342000448112062ULL, 0x0021002400181601ULL, 0x3000104091020804ULL, 0x0801002043040082ULL
+};
+const uint64_t Magic::BISHOP_MAGICS[64] = {
+   0x8040104892809080ULL, 0x2508020814C11120ULL, 0x8008080040880000ULL, 0x0044440380020800ULL,
+   0x0819104008610100ULL, 0x0001012050022008ULL, 0x02020A0120180400ULL, 0x0022011402024202ULL,
+   0x0004501010008080ULL, 0x0054020C4802014CULL, 0x0400100410822100ULL, 0x0000080859004010ULL,
+   0x0080011040000008ULL, 0x0040011008040C02ULL, 0x000002020A200400ULL, 0x8000420080841011ULL,
+   0x0C0A000420040400ULL, 0x100A000418024405ULL, 0xC002001000220C20ULL, 0x8038080304110084ULL,
+   0x0A020084030C0010ULL, 0x0000200202900801ULL, 0x0042181108110428ULL, 0x200A020080410800ULL,
+   0x8020492821420401ULL, 0x0010080004080080ULL, 0x8252024028028408ULL, 0x00C8048008020004ULL,
+   0x002084000B812000ULL, 0x6808420009010120ULL, 0x080A140002012104ULL, 0x1006202214440208ULL,
+   0x00084B3000C00410ULL, 0x0810900420910400ULL, 0x0088109008080042ULL, 0x0000220082080080ULL,
+   0x0C08504040440100ULL, 0x1022018204410800ULL, 0x5541840400008A00ULL, 0x4028008480130842ULL,
+   0x0200C42020E00800ULL, 0x0504010802080800ULL, 0x01A0201048001008ULL, 0x0102102013010800ULL,
+   0x08A1108200900200ULL, 0x0004040802000030ULL, 0x4290041084120080ULL, 0x144408504C410300ULL,
+   0x1004010490840100ULL, 0x4501240208140808ULL, 0x0127010086900000ULL, 0x0200000020880032ULL,
+   0xA000105002020010ULL, 0x2040E0A002848000ULL, 0x8A84080808008000ULL, 0x4050870114008808ULL,
+   0x000040C800982020ULL, 0x1092020047080800ULL, 0x20060A010861100AULL, 0x0000802421840402ULL,
+   0x0024880040429200ULL, 0x0020820408108100ULL, 0x0800842006020621ULL, 0x005002080104BA00ULL
+};
+
+// Fill the tables before main runs
+const Magic Magic::s_Magic;
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Constructor (fill all the tables)
+///
+////////////////////////////////////////////////////////////////////////////////
+Magic::Magic()
+{
+   InitSquares(m_Rook, m_RookTable, ROOK_DIRECTIONS, ROOK_MAGICS);
+   InitSquares(m_Bishop, m_BishopTable, BISHOP_DIRECTIONS, BISHOP_MAGICS);
+   InitRays();
+   InitLeapers();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  For each position, enumerate every subset of the blocker mask
+///           and store the attacks for it in the table
+///
+///   @param squares  Populated with the lookup info for each position
+///   @param table  The attack table shared by all 64 positions
+///   @param directions  The 4 directions the piece can slide in
+///   @param magics  The magic multiplier for each position (unused with BMI2)
+///
+////////////////////////////////////////////////////////////////////////////////
+void Magic::InitSquares(Square squares[64], uint64_t* table, const int directions[4][2], const uint64_t magics[64])
+{
+   uint64_t* next = table;
+   for (int pos = 0; pos < 64; ++pos)
+   {
+      Square& square = squares[pos];
+      square.mask = RelevantMask(pos, directions);
+
+      int bits = __builtin_popcountll(square.mask);
+      square.attacks = next;
+      square.shift = 64 - bits;
+      square.magic = magics[pos];
+
+      // Carry-rippler trick to visit every subset of the mask
+      uint64_t subset = 0;
+      do
+      {
+         next[square.Index(subset)] = SlowAttacks(pos, subset, directions);
+         subset = (subset - square.mask) & square.mask;
+      }
+      while (subset);
+      next += 1 << bits;
+   }
+   ASSERT_EQ(next - table, (directions == ROOK_DIRECTIONS) ? ROOK_TABLE_LEN : BISHOP_TABLE_LEN);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Fill the table of rays used to find the line between two
+///           positions
+///
+////////////////////////////////////////////////////////////////////////////////
+void Magic::InitRays()
+{
+   static const int ALL_DIRECTIONS[8][2] = {{-1, 0}, {1, 0}, {0, 1}, {0, -1},
+                                            {-1, 1}, {-1, -1}, {1, 1}, {1, -1}};
+
+   for (int from = 0; from < 64; ++from)
+   {
+      for (int to = 0; to < 64; ++to)
+      {
+         m_Ray[from][to] = 0;
+      }
+      for (auto direction : ALL_DIRECTIONS)
+      {
+         uint64_t ray = 0;
+         int col = from / 8 + direction[0];
+         int row = from % 8 + direction[1];
+         for (; col >= 0 && col < 8 && row >= 0 && row < 8; col += direction[0], row += direction[1])
+         {
+            ray |= 1ULL << (col * 8 + row);
+         }
+         for (uint64_t remaining = ray; remaining; remaining &= remaining - 1)
+         {
+            m_Ray[from][__builtin_ctzll(remaining)] = ray;
+         }
+      }
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Fill the knight, king and pawn attacks for each position (one
+///           step in each of their directions, if it stays on the board)
+///
+////////////////////////////////////////////////////////////////////////////////
+void Magic::InitLeapers()
+{
+   static const int KNIGHT_STEPS[8][2] = {{-2, 1}, {-2, -1}, {2, 1}, {2, -1},
+                                          {-1, 2}, {-1, -2}, {1, 2}, {1, -2}};
+   static const int KING_STEPS[8][2]   = {{-1, 0}, {1, 0}, {0, 1}, {0, -1},
+                                          {-1, 1}, {-1, -1}, {1, 1}, {1, -1}};
+   static const int PAWN_STEPS[2][2][2] = {{{-1, 1}, {1, 1}},    // White (up)
+                                           {{-1, -1}, {1, -1}}}; // Black (down)
+
+   auto step = [](int pos, const int direction[2])
+   {
+      int col = pos / 8 + direction[0];
+      int row = pos % 8 + direction[1];
+      return (col >= 0 && col < 8 && row >= 0 && row < 8) ? 1ULL << (col * 8 + row) : 0;
+   };
+
+   for (int pos = 0; pos < 64; ++pos)
+   {
+      m_Knight[pos] = 0;
+      m_King[pos] = 0;
+      for (int i = 0; i < 8; ++i)
+      {
+         m_Knight[pos] |= step(pos, KNIGHT_STEPS[i]);
+         m_King[pos] |= step(pos, KING_STEPS[i]);
+      }
+      for (int black = 0; black < 2; ++black)
+      {
+         m_Pawn[black][pos] = step(pos, PAWN_STEPS[black][0]) | step(pos, PAWN_STEPS[black][1]);
+      }
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Walk each ray one square at a time (only used to fill the
+///           tables)
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t Magic::SlowAttacks(int pos, uint64_t occupied, const int directions[4][2])
+{
+   uint64_t attacks = 0;
+   for (int d = 0; d < 4; ++d)
+   {
+      int col = pos / 8 + directions[d][0];
+      int row = pos % 8 + directions[d][1];
+      for (; col >= 0 && col < 8 && row >= 0 && row < 8; col += directions[d][0], row += directions[d][1])
+      {
+         uint64_t posMask = 1ULL << (col * 8 + row);
+         attacks |= posMask;
+         if (occupied & posMask)
+         {
+            break;
+         }
+      }
+   }
+   return attacks;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the squares that could block the piece. The last square in
+///           each direction never blocks anything, so it is left out.
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t Magic::RelevantMask(int pos, const int directions[4][2])
+{
+   uint64_t mask = 0;
+   for (int d = 0; d < 4; ++d)
+   {
+      int col = pos / 8 + directions[d][0];
+      int row = pos % 8 + directions[d][1];
+      for (; col >= 0 && col < 8 && row >= 0 && row < 8; col += directions[d][0], row += directions[d][1])
+      {
+         int nextCol = col + directions[d][0];
+         int nextRow = row + directions[d][1];
+         if (nextCol < 0 || nextCol >= 8 || nextRow < 0 || nextRow >= 8)
+         {
+            break; // Edge of the board
+         }
+         mask |= 1ULL << (col * 8 + row);
+      }
+   }
+   return mask;
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(__BMI2__)
+#include <immintrin.h> // _pext_u64
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Precomputed attack tables for the sliding pieces (rook, bishop,
+///           queen), so an attack mask costs one table lookup instead of a
+///           walk along each ray.
+///
+///           The table for each position is indexed by the occupancy of the
+///           squares the piece could be blocked on. With BMI2 that index is
+///           a PEXT of the occupancy, otherwise it is the usual magic
+///           multiply and shift (by magic numbers that are precomputed). The
+///           tables are filled once, on startup.
+///
+///           The plain attacks of the other pieces (which never depend on
+///           the occupancy) are kept here too, for when only the attacks are
+///           needed and not the moves (e.g. Board::See).
+///
+///           Positions are the same [0, 64) values used by Translate, so
+///           pos = col * 8 + row.
+///
+////////////////////////////////////////////////////////////////////////////////
+class Magic
+{
+public:
+   static uint64_t RookAttacks(int pos, uint64_t occupied);
+   static uint64_t BishopAttacks(int pos, uint64_t occupied);
+   static uint64_t QueenAttacks(int pos, uint64_t occupied);
+   static uint64_t Ray(int from, int to);
+   static uint64_t KnightAttacks(int pos);
+   static uint64_t KingAttacks(int pos);
+   static uint64_t PawnAttacks(bool black, int pos);
+
+protected:
+
+   /////////////////////////////////////////////////////////////////////////////
+   ///
+   ///   @brief  Everything needed to look up the attacks from one position
+   ///
+   /////////////////////////////////////////////////////////////////////////////
+   struct Square
+   {
+      uint64_t Index(uint64_t occupied) const;
+
+      const uint64_t* attacks; // This position's slice of the attack table
+      uint64_t mask;           // Squares that can block, minus the edges
+      uint64_t magic;
+      int shift;
+   };
+
+   Magic();
+   void InitSquares(Square squares[64], uint64_t* table, const int directions[4][2], const uint64_t magics[64]);
+   void InitRays();
+   void InitLeapers();
+
+   static uint64_t SlowAttacks(int pos, uint64_t occupied, const int directions[4][2]);
+   static uint64_t RelevantMask(int pos, const int directions[4][2]);
+
+   static constexpr int ROOK_TABLE_LEN   = 102400; // sum of 2^bits for each pos
+   static constexpr int BISHOP_TABLE_LEN = 5248;
+   static const uint64_t ROOK_MAGICS[64];
+   static const uint64_t BISHOP_MAGICS[64];
+
+   static const Magic s_Magic;
+
+   Square m_Rook[64];
+   Square m_Bishop[64];
+   uint64_t m_RookTable[ROOK_TABLE_LEN];
+   uint64_t m_BishopTable[BISHOP_TABLE_LEN];
+   uint64_t m_Ray[64][64];
+   uint64_t m_Knight[64];
+   uint64_t m_King[64];
+   uint64_t m_Pawn[2][64]; // [black]
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the index into this position's slice of the attack table
+///
+////////////////////////////////////////////////////////////////////////////////
+inline uint64_t Magic::Square::Index(uint64_t occupied) const
+{
+#if defined(__BMI2__)
+   return _pext_u64(occupied, mask);
+#else
+   return ((occupied & mask) * magic) >> shift;
+#endif
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Squares a rook on pos attacks, including the first piece it
+///           runs into in each direction (whoever that piece belongs to)
+///
+////////////////////////////////////////////////////////////////////////////////
+inline uint64_t Magic::RookAttacks(int pos, uint64_t occupied)
+{
+   const Square& square = s_Magic.m_Rook[pos];
+   return square.attacks[square.Index(occupied)];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Squares a bishop on pos attacks, including the first piece it
+///           runs into in each direction (whoever that piece belongs to)
+///
+////////////////////////////////////////////////////////////////////////////////
+inline uint64_t Magic::BishopAttacks(int pos, uint64_t occupied)
+{
+   const Square& square = s_Magic.m_Bishop[pos];
+   return square.attacks[square.Index(occupied)];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A queen is just a rook and a bishop on the same square
+///
+////////////////////////////////////////////////////////////////////////////////
+inline uint64_t Magic::QueenAttacks(int pos, uint64_t occupied)
+{
+   return RookAttacks(pos, occupied) | BishopAttacks(pos, occupied);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Every square past 'from' in the direction of 'to', all the way
+///           to the edge of the board. 0 if they don't share a line.
+///
+////////////////////////////////////////////////////////////////////////////////
+inline uint64_t Magic::Ray(int from, int to)
+{
+   return s_Magic.m_Ray[from][to];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Squares a knight on pos attacks
+///
+////////////////////////////////////////////////////////////////////////////////
+inline uint64_t Magic::KnightAttacks(int pos)
+{
+   return s_Magic.m_Knight[pos];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Squares a king on pos attacks (not counting castling)
+///
+////////////////////////////////////////////////////////////////////////////////
+inline uint64_t Magic::KingAttacks(int pos)
+{
+   return s_Magic.m_King[pos];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Squares a pawn on pos attacks (diagonally forward for its color)
+///
+///           Turned around, PawnAttacks(!black, pos) are the squares the
+///           black (or white) pawns attacking pos would be on.
+///
+////////////////////////////////////////////////////////////////////////////////
+inline uint64_t Magic::PawnAttacks(bool black, int pos)
+{
+   return s_Magic.m_Pawn[black][pos];
+}
@@ -0,0 +1,163 @@
+
+
+#include "PawnStructure.h"
+#include "pieces/Pawn.h"
+#include "io/Translate.h"
+
+
+// A column (the layout has a byte for each) and a row
+static constexpr uint64_t COL_MASK = 0xFFULL;
+static constexpr uint64_t ROW_MASK = 0x0101010101010101ULL;
+
+// Passed pawns by how far they have advanced (rows from their own side)
+static const int PASSED_MG[8] = {0,  5, 10, 15, 25, 45,  70, 0};
+static const int PASSED_EG[8] = {0, 10, 15, 30, 50, 80, 120, 0};
+
+static constexpr int DOUBLED_MG  = -10; // For each pawn behind another
+static constexpr int DOUBLED_EG  = -20;
+static constexpr int ISOLATED_MG = -10; // No pawns on the columns next to it
+static constexpr int ISOLATED_EG = -15;
+static constexpr int BACKWARD_MG = -8;  // Can't be supported as it advances
+static constexpr int BACKWARD_EG = -10;
+static constexpr int SHIELD_1_MG = 10;  // For each pawn 1 row in front of the king
+static constexpr int SHIELD_2_MG = 5;   // 2 rows in front
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Constructor
+///
+////////////////////////////////////////////////////////////////////////////////
+PawnStructure::Entry::Entry()
+   : key(0)
+   , score()
+   , pawns{0, 0}
+   , passed{0, 0}
+{
+
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Calculate the pawn structure terms from the pawn slots in the
+///           bit board (everything but the key)
+///
+////////////////////////////////////////////////////////////////////////////////
+void PawnStructure::Evaluate(const uint8_t* bitBoard, Entry& entry)
+{
+   int positions[2][8];
+   int numPawns[2] = {0, 0};
+   entry.score = Pst::Score();
+   entry.pawns[0] = entry.pawns[1] = 0;
+   entry.passed[0] = entry.passed[1] = 0;
+   
+   // Pawns are in the odd slots of each player's pieces
+   for (int index = BLACK_START + 1; index < BLACK_PROMOTED; index += 2)
+   {
+      if (Piece::GetType(bitBoard, index) == PAWN)
+      {
+         bool black = (index < WHITE_START);
+         int pos = Piece::Pos(bitBoard, index);
+         positions[black][numPawns[black]++] = pos;
+         entry.pawns[black] |= Translate::PosToMask(pos);
+      }
+   }
+   
+   // Where each player's pawns attack
+   uint64_t attacks[2] = {0, 0};
+   for (int black = 0; black < 2; ++black)
+   {
+      Piece::PlayerMasks playerMasks(0, 0, 0, 0, 0, black);
+      Piece::MaskOptions guardOnly(true, true);
+      for (int i = 0; i < numPawns[black]; ++i)
+      {
+         attacks[black] |= Pawn::MoveMask(positions[black][i], playerMasks, guardOnly);
+      }
+   }
+   
+   for (int black = 0; black < 2; ++black)
+   {
+      const uint64_t myPawns = entry.pawns[black];
+      const uint64_t theirPawns = entry.pawns[!black];
+      int mg = 0;
+      int eg = 0;
+      
+      for (int i = 0; i < numPawns[black]; ++i)
+      {
+         const int pos = positions[black][i];
+         const int row = pos % 8; // 0 is white's back row
+         const uint64_t posMask = Translate::PosToMask(pos);
+         const uint64_t col = COL_MASK << (pos / 8 * 8);
+         const uint64_t nextCols = (col << 8) | (col >> 8);
+         
+         // Rows in front of the pawn, and rows level with it or behind
+         uint64_t front = black ? (posMask - 1) : ~((posMask << 1) - 1);
+         uint64_t behind = ROW_MASK * (black ? (COL_MASK & (COL_MASK << row)) : ((2ULL << row) - 1));
+         uint64_t stop = black ? (posMask >> 1) : (posMask << 1);
+         front &= col;
+         
+         if (myPawns & front)
+         {
+            mg += DOUBLED_MG;
+            eg += DOUBLED_EG;
+         }
+         
+         if (!(theirPawns & (front | (front << 8) | (front >> 8))))
+         {
+            int advanced = black ? (TOP_ROW - row) : row;
+            mg += PASSED_MG[advanced];
+            eg += PASSED_EG[advanced];
+            entry.passed[black] |= posMask;
+         }
+         
+         if (!(myPawns & nextCols))
+         {
+            mg += ISOLATED_MG;
+            eg += ISOLATED_EG;
+         }
+         else if (!(myPawns & nextCols & behind) && (attacks[!black] & stop))
+         {
+            mg += BACKWARD_MG;
+            eg += BACKWARD_EG;
+         }
+      }
+      
+      entry.score.mg += black ? -mg : mg;
+      entry.score.eg += black ? -eg : eg;
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Count the pawns in front of each king (while it is still on its
+///           first 2 rows)
+///
+///   @return  The midgame value (there is no shield to speak of in the
+///            endgame)
+///
+////////////////////////////////////////////////////////////////////////////////
+int PawnStructure::Shield(const Entry& entry, const uint8_t* bitBoard)
+{
+   int mg = 0;
+   for (int black = 0; black < 2; ++black)
+   {
+      const int kingPos = Piece::Pos(bitBoard, (black ? BLACK_START : WHITE_START) + K_INDEX);
+      const int row = kingPos % 8;
+      if ((black ? (TOP_ROW - row) : row) > 1)
+      {
+         continue;
+      }
+      
+      const uint64_t col = COL_MASK << (kingPos / 8 * 8);
+      const uint64_t cols = col | (col << 8) | (col >> 8);
+      const uint64_t oneAhead = cols & (ROW_MASK << (black ? row - 1 : row + 1));
+      const uint64_t twoAhead = cols & (ROW_MASK << (black ? row - 2 : row + 2));
+      int shield = SHIELD_1_MG * __builtin_popcountll(entry.pawns[black] & oneAhead) +
+                   SHIELD_2_MG * __builtin_popcountll(entry.pawns[black] & twoAhead);
+      mg += black ? -shield : shield;
+   }
+   return mg;
+}
+
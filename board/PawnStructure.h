@@ -0,0 +1,37 @@
+#pragma once
+
+#include "board/Pst.h"
+#include <cstdint>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Evaluation terms for the pawn structure: passed, doubled,
+///           isolated and backward pawns, and the pawns shielding each king
+///
+///           Everything but the shield depends on the pawns alone, so it is
+///           worked out once per pawn key and cached (see PawnTable). The
+///           shield depends on where the king is too, so it is counted every
+///           time from the pawns kept in the entry (just a few bit-masks).
+///
+///           Like the piece-square score, the terms have a midgame and an
+///           endgame value, and are from white's point of view.
+///
+////////////////////////////////////////////////////////////////////////////////
+class PawnStructure
+{
+public:
+   // What the pawns alone are worth (no pawns at all is all zeros)
+   struct Entry
+   {
+      Entry();
+      uint64_t key; // Zobrist key for the pawns
+      Pst::Score score;
+      uint64_t pawns[2]; // [black] Position bit-masks
+      uint64_t passed[2]; // [black] Passed pawns
+   };
+   
+   static void Evaluate(const uint8_t* bitBoard, Entry& entry);
+   static int Shield(const Entry& entry, const uint8_t* bitBoard);
+};
+
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "pieces/Piece.h"
+#include <cstdint>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Piece-square tables, for a tapered evaluation of the material
+///           and where each piece stands
+///
+///           Every piece has a midgame and an endgame value (in centipawns)
+///           for each position. The score blends the two by the phase, which
+///           counts down from MAX_PHASE as the pieces (not pawns) come off.
+///           Like a Zobrist key, a score is just a sum over the pieces, so
+///           moves update it by taking the old values out and putting the
+///           new ones in.
+///
+///           The tables are the PeSTO tables (tuned by Ronald Friederich),
+///           flipped for black.
+///
+////////////////////////////////////////////////////////////////////////////////
+class Pst
+{
+public:
+   static constexpr int MAX_PHASE = 24; // All the pieces on the board
+   
+   // A score from white's point of view
+   struct Score
+   {
+      Score() : mg(0), eg(0), phase(0) {}
+      bool operator == (const Score& other) const { return mg == other.mg && eg == other.eg && phase == other.phase; }
+      int mg; // Midgame
+      int eg; // Endgame
+      int phase;
+   };
+   
+   static Score Evaluate(const uint8_t* bitBoard);
+   static void Add(Score& score, bool black, PieceType type, int pos);
+   static void Remove(Score& score, bool black, PieceType type, int pos);
+   static int Taper(const Score& score);
+   
+protected:
+   Pst();
+   
+   static const Pst s_Pst;
+   
+   int m_Mg[2][NUM_PIECE_TYPES][64]; // [black][type][pos] (negative for black)
+   int m_Eg[2][NUM_PIECE_TYPES][64];
+   int m_Phase[NUM_PIECE_TYPES];
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Put a piece's values into the score
+///
+////////////////////////////////////////////////////////////////////////////////
+inline void Pst::Add(Score& score, bool black, PieceType type, int pos)
+{
+   score.mg += s_Pst.m_Mg[black][type][pos];
+   score.eg += s_Pst.m_Eg[black][type][pos];
+   score.phase += s_Pst.m_Phase[type];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Take a piece's values out of the score
+///
+////////////////////////////////////////////////////////////////////////////////
+inline void Pst::Remove(Score& score, bool black, PieceType type, int pos)
+{
+   score.mg -= s_Pst.m_Mg[black][type][pos];
+   score.eg -= s_Pst.m_Eg[black][type][pos];
+   score.phase -= s_Pst.m_Phase[type];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Blend the midgame and endgame values by the phase (more than
+///           the starting pieces, e.g. after a promotion, counts as midgame)
+///
+////////////////////////////////////////////////////////////////////////////////
+inline int Pst::Taper(const Score& score)
+{
+   int phase = (score.phase < MAX_PHASE) ? score.phase : MAX_PHASE;
+   return (score.mg * phase + score.eg * (MAX_PHASE - phase)) / MAX_PHASE;
+}
+
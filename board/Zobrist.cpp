@@ -0,0 +1,106 @@
+
+
+#include "Zobrist.h"
+
+
+// Fill the tables before main runs
+const Zobrist Zobrist::s_Zobrist;
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Constructor (fill all the tables)
+///
+////////////////////////////////////////////////////////////////////////////////
+Zobrist::Zobrist()
+{
+   for (auto& color : m_Piece)
+   {
+      for (auto& kind : color)
+      {
+         for (uint64_t& key : kind)
+         {
+            key = Random();
+         }
+      }
+   }
+
+   // One key per castle right, combined for each set of rights
+   uint64_t rights[4] = {Random(), Random(), Random(), Random()};
+   for (int i = 0; i < 16; ++i)
+   {
+      m_Castle[i] = 0;
+      for (int bit = 0; bit < 4; ++bit)
+      {
+         if (i & (1 << bit))
+         {
+            m_Castle[i] ^= rights[bit];
+         }
+      }
+   }
+
+   for (uint64_t& key : m_EnPassant)
+   {
+      key = Random();
+   }
+   m_BlacksTurn = Random();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Calculate the key from scratch
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t Zobrist::Key(const uint8_t* bitBoard)
+{
+   uint64_t key = 0;
+   for (int index = BLACK_START; index < BLACK_PROMOTED; ++index)
+   {
+      key ^= PieceKey(bitBoard, index);
+   }
+   key ^= CastleKey(bitBoard);
+   key ^= EnPassantKey(bitBoard);
+   if (bitBoard[SPECIAL] & BLACKS_TURN_MASK)
+   {
+      key ^= TurnKey();
+   }
+   return key;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Calculate the pawn key from scratch (pawns are in the odd slots
+///           of each player's pieces)
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t Zobrist::PawnKey(const uint8_t* bitBoard)
+{
+   uint64_t key = 0;
+   for (int index = BLACK_START + 1; index < BLACK_PROMOTED; index += 2)
+   {
+      if (Piece::GetType(bitBoard, index) == PAWN)
+      {
+         key ^= PieceKey(bitBoard, index);
+      }
+   }
+   return key;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A 64-bit random number (xorshift with a fixed seed, so keys are
+///           the same from one run to the next)
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t Zobrist::Random()
+{
+   static uint64_t seed = 0x3243F6A8885A308DULL;
+   seed ^= seed >> 12;
+   seed ^= seed << 25;
+   seed ^= seed >> 27;
+   return seed * 0x2545F4914F6CDD1DULL;
+}
+
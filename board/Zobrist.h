@@ -0,0 +1,101 @@
+#pragma once
+
+#include "board/BitBoard.h"
+#include "pieces/Piece.h"
+#include <cstdint>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Random keys used to give each position a 64-bit hash, so
+///           positions can be identified without comparing bit boards.
+///
+///           A key is the XOR of one random number per piece (by type, color
+///           and position), per castle right still available, for the en
+///           passant position (if set) and for black being the turn player.
+///           Moves update a key by XOR-ing the old values out and the new
+///           ones in. Pieces are hashed by type rather than by their index
+///           in the bit board, so the same position reached by different
+///           moves gets the same key.
+///
+///           Nothing at all (an empty board, white's turn) hashes to 0, so a
+///           key computed before the tables are filled is still consistent.
+///
+///           The pawn key is the same, but for just the (unpromoted) pawns.
+///           It only changes when a pawn moves or is captured, so anything
+///           worked out from the pawns alone can be cached by it.
+///
+////////////////////////////////////////////////////////////////////////////////
+class Zobrist
+{
+public:
+   static uint64_t Key(const uint8_t* bitBoard);
+   static uint64_t PawnKey(const uint8_t* bitBoard);
+   static uint64_t PieceKey(const uint8_t* bitBoard, int index);
+   static uint64_t CastleKey(const uint8_t* bitBoard);
+   static uint64_t EnPassantKey(const uint8_t* bitBoard);
+   static uint64_t TurnKey();
+
+protected:
+   Zobrist();
+
+   static uint64_t Random();
+
+   static const Zobrist s_Zobrist;
+
+   uint64_t m_Piece[2][NUM_PIECE_TYPES][64]; // [black][type][pos]
+   uint64_t m_Castle[16]; // Every combination of castle rights
+   uint64_t m_EnPassant[64];
+   uint64_t m_BlacksTurn;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the key for the piece at the index in the bit board, or 0
+///           if it is captured
+///
+////////////////////////////////////////////////////////////////////////////////
+inline uint64_t Zobrist::PieceKey(const uint8_t* bitBoard, int index)
+{
+   PieceType type = Piece::GetType(bitBoard, index);
+   if (type == NUM_PIECE_TYPES)
+   {
+      return 0;
+   }
+   return s_Zobrist.m_Piece[index < WHITE_START][type][bitBoard[index] >> POS_BITSHIFT];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the key for the castle rights both players have left
+///
+////////////////////////////////////////////////////////////////////////////////
+inline uint64_t Zobrist::CastleKey(const uint8_t* bitBoard)
+{
+   return s_Zobrist.m_Castle[(bitBoard[CASTLE_INDEX] >> WHITE_CASTLE_BITSHIFT) & 0x0F];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the key for the en passant position, or 0 if not set
+///
+////////////////////////////////////////////////////////////////////////////////
+inline uint64_t Zobrist::EnPassantKey(const uint8_t* bitBoard)
+{
+   return (bitBoard[SPECIAL] & EN_PASSANT_MASK) ? s_Zobrist.m_EnPassant[bitBoard[SPECIAL] >> POS_BITSHIFT] : 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the key to toggle every time the turn player changes
+///
+////////////////////////////////////////////////////////////////////////////////
+inline uint64_t Zobrist::TurnKey()
+{
+   return s_Zobrist.m_BlacksTurn;
+}
+
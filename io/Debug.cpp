@@ -122,16 +122,24 @@ void PrintMasks(uint64_t mask1, uint64_t mask2, bool labeled)
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Print the piece
+///   @brief  Print the piece at the index in the bit board
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void PrintPiece(const Piece& piece)
+void PrintPiece(const uint8_t* bitBoard, int index)
 {
    const Settings& settings = Settings::Instance();
    if (!settings.silent)
    {
-      std::cerr << (piece.Captured() ? "Captured " : "") << piece.Type() << std::endl;
-      PrintMask(piece.PosMask());
+      PieceType type = Piece::GetType(bitBoard, index);
+      if (type == NUM_PIECE_TYPES)
+      {
+         std::cerr << "Captured" << std::endl;
+      }
+      else
+      {
+         std::cerr << Piece::Name(type) << std::endl;
+         PrintMask(Translate::PosToMask(Piece::Pos(bitBoard, index)));
+      }
    }
 }
 
@@ -154,23 +162,6 @@ void PrintAction(const Action& action, const std::string& prefix_msg)
 }
 
 
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Print the action and the associated heuristic value
-///
-////////////////////////////////////////////////////////////////////////////////
-void PrintAction(const Action& action, const HVal& h_val)
-{
-   const Settings& settings = Settings::Instance();
-   if (!settings.silent)
-   {
-      std::ostringstream oss;
-      oss << "(" << std::to_string(h_val.first) << ", " << std::to_string(h_val.second)  << ") ";
-      PrintAction(action, oss.str());
-   }
-}
-
-
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  Print the action and the associated heuristic value
@@ -1,6 +1,5 @@
 #pragma once
 
-#include "ai/HeuristicValue.h"
 #include "pieces/Piece.h"
 #include "Translate.h"
 #include <bitset>
@@ -23,9 +22,8 @@ void Print(const std::string& msg);
 void PrintPos(int pos);
 void PrintMask(uint64_t mask, bool labeled = false);
 void PrintMasks(uint64_t mask1, uint64_t mask2, bool labeled = false);
-void PrintPiece(const Piece& piece);
+void PrintPiece(const uint8_t* bitBoard, int index);
 void PrintAction(const Action& action, const std::string& prefix_msg = "");
-void PrintAction(const Action& action, const HVal& h_val);
 void PrintAction(const Action& action, int h_val);
 void PrintAction(const Action& action, double h_val);
 void PrintBitBoard(const uint8_t* bitBoard);
@@ -35,6 +35,7 @@ Parser::Parser(const std::string& fen, const Options& options)
    , m_WhiteCount()
    , m_File(LEFT) // min file
    , m_Rank(TOP) // max rank
+   , m_HalfMoves(0)
    , m_Section()
    , m_Options(options)
 {
@@ -110,6 +111,18 @@ BitBoard Parser::GetBitBoard() const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the half moves since the last pawn move or capture (0 if the
+///           fen doesn't give them)
+///
+////////////////////////////////////////////////////////////////////////////////
+int Parser::GetHalfMoves() const
+{
+   return m_HalfMoves;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  Parse a king
@@ -347,6 +360,9 @@ void Parser::ParseSectionDivider()
 ///           For the en passant portion of the fen, this number is the rank
 ///           of the en passant target pos
 ///
+///           For the half move portion of the fen, this is the next digit of
+///           the half move clock
+///
 ///   @param n  The number parsed from the fen
 ///
 ////////////////////////////////////////////////////////////////////////////////
@@ -361,8 +377,11 @@ void Parser::ParseNumber(int n)
       m_Rank = n;
       m_Bytes[SPECIAL] |= (GetPos() << POS_BITSHIFT) | EN_PASSANT_MASK;
    }
-   else if (m_Section.id == Section::HALF_MOVE ||
-            m_Section.id == Section::FULL_MOVE)
+   else if (m_Section.id == Section::HALF_MOVE)
+   {
+      m_HalfMoves = m_HalfMoves * 10 + n;
+   }
+   else if (m_Section.id == Section::FULL_MOVE)
    {
       // Don't care
    }
@@ -28,6 +28,7 @@ public:
    
    Parser(const std::string& fen, const Options& options = Options());
    BitBoard GetBitBoard() const;
+   int GetHalfMoves() const;
    
 protected:
    
@@ -88,6 +89,7 @@ protected:
 
    char m_File;
    int m_Rank;
+   int m_HalfMoves; // Since the last pawn move or capture
    
    Section m_Section;
    
@@ -42,6 +42,18 @@ uint64_t Translate::PosToMask(int pos)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the position of the (lowest) bit set in the mask
+///
+////////////////////////////////////////////////////////////////////////////////
+int Translate::MaskToPos(uint64_t mask)
+{
+   ASSERT_NE(0, mask);
+   return __builtin_ctzll(mask);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  Translate col and row indexes to a position
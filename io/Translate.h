@@ -26,6 +26,7 @@ class Translate
 public:
    static std::string MaskToStr(uint64_t mask, bool labeled = false);
    static uint64_t PosToMask(int pos);
+   static int MaskToPos(uint64_t mask);
    static int ColRowToPos(int col, int row);
    static int FileRankToPos(const std::string& file, int rank);
    static std::pair<std::string, int> PosToFileRank(int pos);
@@ -0,0 +1,556 @@
+
+
+#include "Uci.h"
+#include "Error.h"
+#include "Translate.h"
+#include "ai/AiHelper.h"
+#include "ai/MoveList.h"
+#include "ai/Settings.h"
+#include "ai/Timer.h"
+#include "ai/TranspositionTable.h"
+#include <algorithm>
+#include <cctype>
+
+
+const std::string Uci::START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Constructor (starts at the starting position)
+///
+///   @param out  Where to send the engine's side of the protocol
+///
+////////////////////////////////////////////////////////////////////////////////
+Uci::Uci(std::ostream& out)
+   : m_Out(out)
+   , m_OutMutex()
+   , m_State(START_FEN)
+   , m_Fen(START_FEN)
+   , m_Moves()
+   , m_pContext(new SearchContext())
+   , m_Limits()
+   , m_StartNodes(0)
+   , m_Thread()
+   , m_Mutex()
+   , m_Stopped()
+   , m_StopRequested(false)
+   , m_Discard(false)
+{
+   Settings::Instance().silent = true; // Until 'debug on'
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Destructor (stops the search, if there is one)
+///
+////////////////////////////////////////////////////////////////////////////////
+Uci::~Uci()
+{
+   StopSearch(true);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Read and handle commands until 'quit' (or the end of the input)
+///
+///           At the end of the input, a search with limits is left to finish,
+///           so piped commands still get their best move.
+///
+////////////////////////////////////////////////////////////////////////////////
+void Uci::Run(std::istream& in)
+{
+   std::string line;
+   while (std::getline(in, line))
+   {
+      if (!Command(line))
+      {
+         return;
+      }
+   }
+   if (m_Thread.joinable())
+   {
+      if (m_Limits.infinite || m_Limits.ponder)
+      {
+         StopSearch(false);
+      }
+      else
+      {
+         m_Thread.join();
+      }
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Handle one command
+///
+///   @return  false if it was 'quit'
+///
+////////////////////////////////////////////////////////////////////////////////
+bool Uci::Command(const std::string& line)
+{
+   std::istringstream args(line);
+   std::string command;
+   args >> command;
+   try
+   {
+      if (command == "uci")
+      {
+         Identify();
+      }
+      else if (command == "debug")
+      {
+         std::string onOff;
+         args >> onOff;
+         Settings::Instance().silent = (onOff != "on");
+      }
+      else if (command == "isready")
+      {
+         Send("readyok");
+      }
+      else if (command == "setoption")
+      {
+         StopSearch(true);
+         SetOption(args);
+      }
+      else if (command == "ucinewgame")
+      {
+         StopSearch(true);
+         NewGame();
+      }
+      else if (command == "position")
+      {
+         StopSearch(true);
+         Position(args);
+      }
+      else if (command == "go")
+      {
+         StopSearch(true);
+         Go(args);
+      }
+      else if (command == "stop")
+      {
+         StopSearch(false);
+      }
+      else if (command == "ponderhit")
+      {
+         PonderHit();
+      }
+      else if (command == "quit")
+      {
+         StopSearch(true);
+         return false;
+      }
+      else if (!command.empty())
+      {
+         Send("info string Unknown command: " + command);
+      }
+   }
+   catch (const Error& e)
+   {
+      Send(std::string("info string ") + e.what());
+   }
+   return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Answer 'uci' with the engine's name and options
+///
+////////////////////////////////////////////////////////////////////////////////
+void Uci::Identify()
+{
+   const Settings& settings = Settings::Instance();
+   Send("id name chess-ai");
+   Send("id author vtad4f");
+   Send("option name Hash type spin default " + std::to_string(settings.hash_mb) + " min 0 max 4096");
+   Send("option name Threads type spin default " + std::to_string(std::max(settings.threads, 1)) + " min 1 max 256");
+   Send("option name Ponder type check default false");
+   Send("uciok");
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Handle 'setoption name <name> [value <value>]'
+///
+////////////////////////////////////////////////////////////////////////////////
+void Uci::SetOption(std::istringstream& args)
+{
+   std::string token, name, value;
+   std::string* pField = nullptr;
+   while (args >> token)
+   {
+      if (token == "name")
+      {
+         pField = &name;
+      }
+      else if (token == "value")
+      {
+         pField = &value;
+      }
+      else if (pField)
+      {
+         *pField += (pField->empty() ? "" : " ") + token;
+      }
+   }
+   std::transform(name.begin(), name.end(), name.begin(), ::tolower); // Names aren't case sensitive
+
+   Settings& settings = Settings::Instance();
+   if (name == "hash")
+   {
+      settings.hash_mb = std::max(std::stoi(value), 0);
+      TranspositionTable::Instance().Resize(settings.hash_mb);
+   }
+   else if (name == "threads")
+   {
+      settings.threads = std::max(std::stoi(value), 1);
+   }
+   else if (name != "ponder") // The GUI decides when to 'go ponder'
+   {
+      Send("info string Unknown option: " + name);
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Forget everything learned in the last game
+///
+////////////////////////////////////////////////////////////////////////////////
+void Uci::NewGame()
+{
+   TranspositionTable::Instance().Clear();
+   m_pContext.reset(new SearchContext());
+   m_Fen.clear(); // So the next position starts over (and its history is kept)
+   m_Moves.clear();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Handle 'position [startpos | fen <fen>] [moves <move> ...]'
+///
+///           If it is the last position with more moves, only the new moves
+///           are applied.
+///
+////////////////////////////////////////////////////////////////////////////////
+void Uci::Position(std::istringstream& args)
+{
+   std::string token, fen;
+   args >> token;
+   if (token == "startpos")
+   {
+      fen = START_FEN;
+      args >> token;
+   }
+   else if (token == "fen")
+   {
+      while (args >> token && token != "moves")
+      {
+         fen += (fen.empty() ? "" : " ") + token;
+      }
+   }
+   else
+   {
+      Send("info string Expected startpos or fen");
+      return;
+   }
+
+   std::vector<std::string> moves;
+   if (token == "moves")
+   {
+      while (args >> token)
+      {
+         moves.push_back(token);
+      }
+   }
+
+   bool sameGame = (fen == m_Fen && moves.size() >= m_Moves.size() &&
+                    std::equal(m_Moves.begin(), m_Moves.end(), moves.begin()));
+   if (!sameGame)
+   {
+      m_State.Refresh(fen);
+      m_Fen = fen;
+      m_Moves.clear();
+      m_pContext->gameKeys.clear();
+   }
+   for (size_t i = m_Moves.size(); i < moves.size(); ++i)
+   {
+      if (!ApplyMove(moves[i]))
+      {
+         Send("info string Illegal move: " + moves[i]);
+         return;
+      }
+      m_Moves.push_back(moves[i]);
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Handle 'go' (with any of the limits below) by starting a search
+///
+////////////////////////////////////////////////////////////////////////////////
+void Uci::Go(std::istringstream& args)
+{
+   m_Limits = Limits();
+   std::string token;
+   while (args >> token)
+   {
+      if      (token == "wtime")     { args >> m_Limits.wtime; }
+      else if (token == "btime")     { args >> m_Limits.btime; }
+      else if (token == "winc")      { args >> m_Limits.winc; }
+      else if (token == "binc")      { args >> m_Limits.binc; }
+      else if (token == "movestogo") { args >> m_Limits.movestogo; }
+      else if (token == "movetime")  { args >> m_Limits.movetime; }
+      else if (token == "depth")     { args >> m_Limits.depth; }
+      else if (token == "mate")      { args >> m_Limits.mate; }
+      else if (token == "infinite")  { m_Limits.infinite = true; }
+      else if (token == "ponder")    { m_Limits.ponder = true; }
+   }
+
+   // With no limit at all, search until told to stop
+   if (!m_Limits.wtime && !m_Limits.btime && !m_Limits.movetime && !m_Limits.depth && !m_Limits.mate)
+   {
+      m_Limits.infinite = true;
+   }
+   StartSearch();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The opponent made the move we were pondering, so search it for
+///           real (the table is already full of the ponder search's values)
+///
+////////////////////////////////////////////////////////////////////////////////
+void Uci::PonderHit()
+{
+   if (m_Thread.joinable() && m_Limits.ponder)
+   {
+      StopSearch(true);
+      m_Limits.ponder = false;
+      StartSearch();
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Apply a move in long algebraic notation (e.g. e2e4, e7e8q)
+///
+///   @return  false if it isn't a valid move in the current state
+///
+////////////////////////////////////////////////////////////////////////////////
+bool Uci::ApplyMove(const std::string& move)
+{
+   if (move.size() < 4 || move.size() > 5)
+   {
+      return false;
+   }
+
+   MoveList moves;
+   m_State.GetActions(moves, ~0ULL);
+   int i = moves.Find(Action(move.substr(0, 2), move.substr(2, 2), move.substr(4)));
+   if (i < 0)
+   {
+      return false;
+   }
+
+   Action action = moves.Get(i);
+   m_pContext->gameKeys.push_back(m_State.Key());
+   m_State.ApplyAction(action);
+   if (m_State.HalfMoves() == 0)
+   {
+      m_pContext->gameKeys.clear(); // Nothing before a pawn move or capture can repeat
+   }
+   return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Set the time and depth limits, then start the search thread
+///
+////////////////////////////////////////////////////////////////////////////////
+void Uci::StartSearch()
+{
+   Settings& settings = Settings::Instance();
+   settings.max_depth_limit = m_Limits.depth;
+   settings.mate_moves = std::max(m_Limits.mate, 0);
+   if (settings.mate_moves > 0 && (!m_Limits.depth || m_Limits.depth > 2 * settings.mate_moves))
+   {
+      settings.max_depth_limit = 2 * settings.mate_moves; // Through the mated player's turn (no moves)
+   }
+   double remaining_s = 0.0;
+   double increment_s = 0.0;
+   if (m_Limits.infinite || m_Limits.ponder)
+   {
+      settings.seconds_limit = 0.0; // No limit
+   }
+   else if (m_Limits.movetime)
+   {
+      settings.seconds_limit = m_Limits.movetime / 1000.0;
+   }
+   else if (m_Limits.wtime || m_Limits.btime)
+   {
+      settings.seconds_limit = -1.0; // A share of what's left (see Timer::Restart)
+      remaining_s = (m_State.BlacksTurn() ? m_Limits.btime : m_Limits.wtime) / 1000.0;
+      increment_s = (m_State.BlacksTurn() ? m_Limits.binc : m_Limits.winc) / 1000.0;
+   }
+   else
+   {
+      settings.seconds_limit = 0.0; // Just the depth limit
+   }
+   Timer::Instance().Restart(remaining_s, increment_s, m_Limits.movestogo);
+
+   m_StopRequested = false;
+   m_Discard = false;
+   m_StartNodes = m_pContext->nodes;
+   m_pContext->onDepth = [this](const SearchContext& context) { SendInfo(context); };
+   m_Thread = std::thread(&Uci::Search, this);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Stop the search (if there is one) and wait for its thread
+///
+///   @param discard  Don't send its best move
+///
+////////////////////////////////////////////////////////////////////////////////
+void Uci::StopSearch(bool discard)
+{
+   if (!m_Thread.joinable())
+   {
+      return;
+   }
+   {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_StopRequested = true;
+      m_Discard = m_Discard || discard;
+   }
+   m_Stopped.notify_all();
+   Timer::Instance().Stop();
+   m_Thread.join();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The search thread. Infinite and ponder searches don't send their
+///           best move until told to stop, even if they finish first.
+///
+////////////////////////////////////////////////////////////////////////////////
+void Uci::Search()
+{
+   std::string best = "0000"; // Null move, if there isn't one
+   try
+   {
+      best = MoveToStr(AiHelper::ID_DL_MiniMax(*m_pContext, m_State));
+   }
+   catch (const Error& e)
+   {
+      Send(std::string("info string ") + e.what());
+   }
+
+   std::unique_lock<std::mutex> lock(m_Mutex);
+   if (m_Limits.infinite || m_Limits.ponder)
+   {
+      m_Stopped.wait(lock, [this]() { return m_StopRequested; });
+   }
+   if (!m_Discard)
+   {
+      Send("bestmove " + best);
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Send what the search has found so far (after each depth)
+///
+////////////////////////////////////////////////////////////////////////////////
+void Uci::SendInfo(const SearchContext& context)
+{
+   double elapsed = Timer::Instance().Elapsed();
+   uint64_t nodes = context.nodes - m_StartNodes;
+   std::ostringstream oss;
+   oss << "info depth " << context.depthLimit
+       << " score " << ScoreToStr(context.bestAction.first)
+       << " nodes " << nodes
+       << " nps " << static_cast<uint64_t>(elapsed > 0 ? nodes / elapsed : 0)
+       << " time " << static_cast<int>(elapsed * 1000)
+       << " pv " << MoveToStr(context.bestAction.second);
+   Send(oss.str());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Send a line (from either thread)
+///
+////////////////////////////////////////////////////////////////////////////////
+void Uci::Send(const std::string& line)
+{
+   std::lock_guard<std::mutex> lock(m_OutMutex);
+   m_Out << line << std::endl;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the action in long algebraic notation (e.g. e2e4, e7e8q)
+///
+////////////////////////////////////////////////////////////////////////////////
+std::string Uci::MoveToStr(const SimpleAction& action)
+{
+   return Translate::PosToAlgebraicStr(action.start_pos) +
+          Translate::PosToAlgebraicStr(action.end_pos) +
+          (action.promoted ? Translate::PromotionIntToStr(action.promoted_type) : "");
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the value as a UCI score, either centipawns (e.g. cp 35) or
+///           moves to a checkmate (e.g. mate 3, or mate -2 if it is ours)
+///
+////////////////////////////////////////////////////////////////////////////////
+std::string Uci::ScoreToStr(HVal value)
+{
+   if (!hval::IsMate(value))
+   {
+      return "cp " + std::to_string(value);
+   }
+   int plies = hval::MatePlies(value);
+   return "mate " + std::to_string((value > 0) ? (plies + 1) / 2 : -plies / 2);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Constructor (no limits)
+///
+////////////////////////////////////////////////////////////////////////////////
+Uci::Limits::Limits()
+   : wtime(0)
+   , btime(0)
+   , winc(0)
+   , binc(0)
+   , movestogo(0)
+   , movetime(0)
+   , depth(0)
+   , mate(0)
+   , infinite(false)
+   , ponder(false)
+{
+
+}
+
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "ai/Action.h"
+#include "ai/SearchContext.h"
+#include "ai/State.h"
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A long running engine that talks the Universal Chess Interface
+///           protocol, so the state, history table and transposition table
+///           stay warm from one move to the next (the table's values don't
+///           depend on the root, so the next search starts with whatever
+///           was stored below the move played)
+///
+///           Searches run on their own thread, so commands like 'stop' and
+///           'isready' are still read while searching.
+///
+////////////////////////////////////////////////////////////////////////////////
+class Uci
+{
+public:
+   explicit Uci(std::ostream& out);
+   Uci(const Uci&) = delete;
+   Uci& operator = (const Uci&) = delete;
+   ~Uci();
+
+   void Run(std::istream& in);
+   bool Command(const std::string& line);
+
+protected:
+   static const std::string START_FEN;
+
+   // Limits from the 'go' command (times in milliseconds, 0 if not set)
+   struct Limits
+   {
+      Limits();
+
+      int wtime;
+      int btime;
+      int winc;
+      int binc;
+      int movestogo;
+      int movetime;
+      int depth;
+      int mate; // Moves
+      bool infinite;
+      bool ponder;
+   };
+
+   void Identify();
+   void SetOption(std::istringstream& args);
+   void NewGame();
+   void Position(std::istringstream& args);
+   void Go(std::istringstream& args);
+   void PonderHit();
+
+   bool ApplyMove(const std::string& move);
+   void StartSearch();
+   void StopSearch(bool discard);
+   void Search();
+   void SendInfo(const SearchContext& context);
+   void Send(const std::string& line);
+
+   static std::string MoveToStr(const SimpleAction& action);
+   static std::string ScoreToStr(HVal value);
+
+   std::ostream& m_Out;
+   std::mutex m_OutMutex;
+
+   State m_State;
+   std::string m_Fen; // The last position's fen and moves (to skip the ones
+   std::vector<std::string> m_Moves; // already applied to m_State)
+
+   std::unique_ptr<SearchContext> m_pContext;
+   Limits m_Limits;
+   uint64_t m_StartNodes;
+   std::thread m_Thread;
+   std::mutex m_Mutex; // For the flags below
+   std::condition_variable m_Stopped;
+   bool m_StopRequested; // Infinite and ponder searches wait for this
+   bool m_Discard; // Don't send the best move (e.g. after 'ponderhit')
+};
+
@@ -1,6 +1,7 @@
 
 
 #include "ai/AiPlayer.h"
+#include "io/Uci.h"
 #include <iostream>
 #include <string>
 
@@ -8,15 +9,21 @@
 int main(int argc, char **argv)
 {
    int actual_argc = argc - 1;
-   if (actual_argc < 2)
+   if (actual_argc == 1)
    {
-      std::cerr << "Usage:  " << argv[0] << " <fen> <turn_limit_s>" << std::endl;
+      std::cerr << "Usage:  " << argv[0] << " <fen> <turn_limit_s>" << std::endl
+                << "        " << argv[0] << "   (no args for a UCI engine)" << std::endl;
       return 1;
    }
    
    AiPlayer player;
    player.Init();
+   if (actual_argc == 0)
+   {
+      Uci uci(std::cout);
+      uci.Run(std::cin);
+      return 0;
+   }
    player.MyTurn(argv[1], atof(argv[2]));
    return 0;
 }
-
@@ -2,7 +2,8 @@
 
 #include "King.h"
 #include "board/BitBoard.h"
-#include "io/Error.h"
+#include "board/Zobrist.h"
+#include "io/Translate.h"
 
 
 // Black is on top. White is on bottom.
@@ -30,69 +31,26 @@ static constexpr int TWO_SPACES_HORIZONTAL = 16;
 static constexpr int ONE_SPACE_HORIZONTAL  = 8;
 
 
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Constructor
-///
-////////////////////////////////////////////////////////////////////////////////
-King::King(const uint8_t* bitBoard, bool black)
-   : Piece(bitBoard,     (black ? BLACK_START                 : WHITE_START) + K_INDEX     )
-   , m_CastleBitshift    (black ? BLACK_CASTLE_BITSHIFT       : WHITE_CASTLE_BITSHIFT      )
-   , m_R1CastlePiecesMask(black ? BLACK_R1_CASTLE_PIECES_MASK : WHITE_R1_CASTLE_PIECES_MASK)
-   , m_R2CastlePiecesMask(black ? BLACK_R2_CASTLE_PIECES_MASK : WHITE_R2_CASTLE_PIECES_MASK)
-   , m_R1CastleThreatMask(black ? BLACK_R1_CASTLE_THREAT_MASK : WHITE_R1_CASTLE_THREAT_MASK)
-   , m_R2CastleThreatMask(black ? BLACK_R2_CASTLE_THREAT_MASK : WHITE_R2_CASTLE_THREAT_MASK)
-   , m_R1CastleKingPos   (black ? BLACK_R1_CASTLE_KING_POS    : WHITE_R1_CASTLE_KING_POS   )
-   , m_R2CastleKingPos   (black ? BLACK_R2_CASTLE_KING_POS    : WHITE_R2_CASTLE_KING_POS   )
-   , m_R1Index(          (black ? BLACK_START                 : WHITE_START) + R1_INDEX    )
-   , m_R2Index(          (black ? BLACK_START                 : WHITE_START) + R2_INDEX    )
-{
-   
-}
+// Castle masks by player [black]
+static constexpr uint64_t R1_CASTLE_PIECES_MASK[2] = {WHITE_R1_CASTLE_PIECES_MASK, BLACK_R1_CASTLE_PIECES_MASK};
+static constexpr uint64_t R2_CASTLE_PIECES_MASK[2] = {WHITE_R2_CASTLE_PIECES_MASK, BLACK_R2_CASTLE_PIECES_MASK};
+static constexpr uint64_t R1_CASTLE_THREAT_MASK[2] = {WHITE_R1_CASTLE_THREAT_MASK, BLACK_R1_CASTLE_THREAT_MASK};
+static constexpr uint64_t R2_CASTLE_THREAT_MASK[2] = {WHITE_R2_CASTLE_THREAT_MASK, BLACK_R2_CASTLE_THREAT_MASK};
+static constexpr uint64_t R1_CASTLE_KING_POS[2]    = {WHITE_R1_CASTLE_KING_POS,    BLACK_R1_CASTLE_KING_POS   };
+static constexpr uint64_t R2_CASTLE_KING_POS[2]    = {WHITE_R2_CASTLE_KING_POS,    BLACK_R2_CASTLE_KING_POS   };
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Destructor
+///   @brief  Move the king at the index to its new position
 ///
 ////////////////////////////////////////////////////////////////////////////////
-King::~King()
+void King::Move(uint8_t* bitBoard, uint64_t& key, int index, const Action& action)
 {
+   Piece::Move(bitBoard, key, index, action);
    
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Get the piece type as a string
-///
-////////////////////////////////////////////////////////////////////////////////
-std::string King::Type() const
-{
-   return "King";
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Don't try to get the value of a king. Infinite would be
-///           suitable, but really it shouldn't be compared to other pieces.
-///
-////////////////////////////////////////////////////////////////////////////////
-int King::Value() const
-{
-   EXIT("Shouldn't be trying to retrieve the king's value");
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Move the piece to its new position
-///
-////////////////////////////////////////////////////////////////////////////////
-void King::Move(uint8_t* bitBoard, const Action& action) const
-{
-   Piece::Move(bitBoard, action);
+   const int start = index - K_INDEX; // BLACK_START or WHITE_START
+   const int castleBitshift = (start == BLACK_START) ? BLACK_CASTLE_BITSHIFT : WHITE_CASTLE_BITSHIFT;
    
    // Account for castling
    if (action.end_pos < action.start_pos)
@@ -100,8 +58,11 @@ void King::Move(uint8_t* bitBoard, const Action& action) const
       // Move r1 if we castled left
       if (action.end_pos + TWO_SPACES_HORIZONTAL == action.start_pos)
       {
-         bitBoard[m_R1Index] &= CLEAR_POS_MASK;
-         bitBoard[m_R1Index] |= (action.end_pos + ONE_SPACE_HORIZONTAL) << POS_BITSHIFT;
+         const int r1Index = start + R1_INDEX;
+         key ^= Zobrist::PieceKey(bitBoard, r1Index);
+         bitBoard[r1Index] &= CLEAR_POS_MASK;
+         bitBoard[r1Index] |= (action.end_pos + ONE_SPACE_HORIZONTAL) << POS_BITSHIFT;
+         key ^= Zobrist::PieceKey(bitBoard, r1Index);
       }
    }
    else
@@ -109,80 +70,41 @@ void King::Move(uint8_t* bitBoard, const Action& action) const
       // Move r2 if we castled right
       if (action.start_pos + TWO_SPACES_HORIZONTAL == action.end_pos)
       {
-         bitBoard[m_R2Index] &= CLEAR_POS_MASK;
-         bitBoard[m_R2Index] |= (action.start_pos + ONE_SPACE_HORIZONTAL) << POS_BITSHIFT;
+         const int r2Index = start + R2_INDEX;
+         key ^= Zobrist::PieceKey(bitBoard, r2Index);
+         bitBoard[r2Index] &= CLEAR_POS_MASK;
+         bitBoard[r2Index] |= (action.start_pos + ONE_SPACE_HORIZONTAL) << POS_BITSHIFT;
+         key ^= Zobrist::PieceKey(bitBoard, r2Index);
       }
    }
    
    // Clear castle flags
-   if (CastleAvailable())
+   if ((bitBoard[CASTLE_INDEX] >> castleBitshift) & R1R2_CASTLE_MASK)
    {
-      bitBoard[CASTLE_INDEX] &= ~(R1R2_CASTLE_MASK << m_CastleBitshift);
+      key ^= Zobrist::CastleKey(bitBoard);
+      bitBoard[CASTLE_INDEX] &= ~(R1R2_CASTLE_MASK << castleBitshift);
+      key ^= Zobrist::CastleKey(bitBoard);
    }
 }
 
 
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Set the state of this piece to captured
-///
-////////////////////////////////////////////////////////////////////////////////
-void King::SetCaptured(uint8_t* bitBoard) const
-{
-   EXIT("King shouldn't be captured");
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Check to see if the king has moved or either rook has moved
-///
-////////////////////////////////////////////////////////////////////////////////
-bool King::CastleAvailable() const
-{
-   return (m_BitBoard[CASTLE_INDEX] >> m_CastleBitshift) & R1R2_CASTLE_MASK;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Check to see if the king has moved or rook 1 has moved
-///
-////////////////////////////////////////////////////////////////////////////////
-bool King::RlCastleAvailable() const
-{
-   return (m_BitBoard[CASTLE_INDEX] >> m_CastleBitshift) & R1_CASTLE_MASK;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Check to see if the king has moved or rook 2 has moved
-///
-////////////////////////////////////////////////////////////////////////////////
-bool King::R2CastleAvailable() const
-{
-   return (m_BitBoard[CASTLE_INDEX] >> m_CastleBitshift) & R2_CASTLE_MASK;
-}
-
-
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  Represent all the moves a king can make as a bit mask
 ///
 ////////////////////////////////////////////////////////////////////////////////
-uint64_t King::MoveMask(const PlayerMasks& playerMasks, const MaskOptions& maskOptions) const
+uint64_t King::MoveMask(int pos, const PlayerMasks& playerMasks, const MaskOptions& maskOptions)
 {
-   if (Captured() || maskOptions.blockableKingAttack || maskOptions.skipKing)
+   if (maskOptions.blockableKingAttack || maskOptions.skipKing)
    {
       return 0;
    }
    
-   const uint64_t posMask = PosMask();
+   const uint64_t posMask = Translate::PosToMask(pos);
    uint64_t moveMask = 0;
    
-   const int row = Row();
-   const int col = Col();
+   const int row = Row(pos);
+   const int col = Col(pos);
    
    bool not_top    = row < TOP_ROW;
    bool not_bottom = row > BOTTOM_ROW;
@@ -238,17 +160,19 @@ uint64_t King::MoveMask(const PlayerMasks& playerMasks, const MaskOptions& maskO
    {
       uint64_t piecesMask = playerMasks.myPieces | playerMasks.theirPieces;
       
-      if (RlCastleAvailable() &&
-         !(m_R1CastlePiecesMask & piecesMask) && 
-         !(m_R1CastleThreatMask & playerMasks.myKingsDangerSquares))
+      const bool black = playerMasks.black;
+      
+      if ((playerMasks.castleRights & R1_CASTLE_MASK) &&
+         !(R1_CASTLE_PIECES_MASK[black] & piecesMask) && 
+         !(R1_CASTLE_THREAT_MASK[black] & playerMasks.myKingsDangerSquares))
       {
-         moveMask |= m_R1CastleKingPos;
+         moveMask |= R1_CASTLE_KING_POS[black];
       }
-      if (R2CastleAvailable() &&
-         !(m_R2CastlePiecesMask & piecesMask) &&
-         !(m_R2CastleThreatMask & playerMasks.myKingsDangerSquares))
+      if ((playerMasks.castleRights & R2_CASTLE_MASK) &&
+         !(R2_CASTLE_PIECES_MASK[black] & piecesMask) &&
+         !(R2_CASTLE_THREAT_MASK[black] & playerMasks.myKingsDangerSquares))
       {
-         moveMask |= m_R2CastleKingPos;
+         moveMask |= R2_CASTLE_KING_POS[black];
       }
    }
    return moveMask;
@@ -26,30 +26,10 @@
 class King : public Piece
 {
 public:
-   King(const uint8_t* bitBoard, bool black);
-   virtual ~King();
+   static constexpr PieceType TYPE = KING;
    
-   virtual std::string Type() const override;
-   virtual int Value() const override;
+   static void Move(uint8_t* bitBoard, uint64_t& key, int index, const Action& action);
    
-   virtual void Move(uint8_t* bitBoard, const Action& action) const override;
-   virtual void SetCaptured(uint8_t* bitBoard) const override;
-   
-   virtual uint64_t MoveMask(const PlayerMasks& playerMasks, const MaskOptions& maskOptions = MaskOptions()) const override;
-   
-protected:
-   bool CastleAvailable() const;
-   bool RlCastleAvailable() const;
-   bool R2CastleAvailable() const;
-   
-   int m_CastleBitshift;
-   uint64_t m_R1CastlePiecesMask; // Don't castle if pieces are in the way
-   uint64_t m_R2CastlePiecesMask;
-   uint64_t m_R1CastleThreatMask; // Don't castle through check
-   uint64_t m_R2CastleThreatMask;
-   uint64_t m_R1CastleKingPos; // The destination square for the king when castling
-   uint64_t m_R2CastleKingPos;
-   uint64_t m_R1Index; // King will move the rook when it castles
-   uint64_t m_R2Index;
+   static uint64_t MoveMask(int pos, const PlayerMasks& playerMasks, const MaskOptions& maskOptions = MaskOptions());
 };
 
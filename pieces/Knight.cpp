@@ -1,53 +1,7 @@
 
 
 #include "Knight.h"
-#include "board/BitBoard.h"
-#include "io/Error.h"
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Constructor
-///
-////////////////////////////////////////////////////////////////////////////////
-Knight::Knight(const uint8_t* bitBoard, bool black, int knight_i)
-   : Piece(bitBoard, (black ? BLACK_START : WHITE_START) + (knight_i == 0 ? N1_INDEX : N2_INDEX))
-{
-   
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Destructor
-///
-////////////////////////////////////////////////////////////////////////////////
-Knight::~Knight()
-{
-   
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Get the piece type as a string
-///
-////////////////////////////////////////////////////////////////////////////////
-std::string Knight::Type() const
-{
-   return "Knight";
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Get the value for the knight
-///
-////////////////////////////////////////////////////////////////////////////////
-int Knight::Value() const
-{
-   return Knight::VALUE;
-}
+#include "io/Translate.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -55,26 +9,19 @@ int Knight::Value() const
 ///   @brief  Represent all the moves a knight can make as a bit mask
 ///
 ////////////////////////////////////////////////////////////////////////////////
-uint64_t Knight::MoveMask(const PlayerMasks& playerMasks, const MaskOptions& maskOptions) const
-{
-   return Captured() ? 0 : __MoveMask(PosMask(), Row(), Col(), playerMasks, maskOptions);
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Represent all the moves a knight can make as a bit mask
-///
-////////////////////////////////////////////////////////////////////////////////
-uint64_t Knight::__MoveMask(uint64_t posMask, int row, int col, const PlayerMasks& playerMasks, const MaskOptions& maskOptions)
+uint64_t Knight::MoveMask(int pos, const PlayerMasks& playerMasks, const MaskOptions& maskOptions)
 {
    if (maskOptions.blockableKingAttack)
    {
       return 0;
    }
    
+   const uint64_t posMask = Translate::PosToMask(pos);
    uint64_t moveMask = 0;
    
+   const int row = Row(pos);
+   const int col = Col(pos);
+   
    bool not_top     = row < TOP_ROW;
    bool not_top2    = row < TOP_ROW - 1;
    bool not_bottom  = row > BOTTOM_ROW;
@@ -13,17 +13,9 @@
 class Knight : public Piece
 {
 public:
+   static constexpr PieceType TYPE = KNIGHT;
    static const int VALUE = 3;
    
-   Knight(const uint8_t* bitBoard, bool black, int knight_i);
-   virtual ~Knight();
-   
-   virtual std::string Type() const override;
-   virtual int Value() const override;
-   
-   virtual uint64_t MoveMask(const PlayerMasks& playerMasks, const MaskOptions& maskOptions = MaskOptions()) const override;
-   static uint64_t __MoveMask(uint64_t posMask, int row, int col, const PlayerMasks& playerMasks, const MaskOptions& maskOptions);
-   
-protected:
+   static uint64_t MoveMask(int pos, const PlayerMasks& playerMasks, const MaskOptions& maskOptions = MaskOptions());
 };
 
@@ -1,157 +1,34 @@
 
 
 #include "Pawn.h"
-#include "Queen.h"
-#include "Rook.h"
-#include "Bishop.h"
-#include "Knight.h"
 #include "ai/Settings.h"
 #include "io/Translate.h"
 #include "board/BitBoard.h"
-#include "io/Error.h"
-#include "io/Debug.h"
+#include "board/Zobrist.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Constructor
+///   @brief  Push actions for every move in the bit-mask (four promotions
+///           for each move to the last row)
 ///
 ////////////////////////////////////////////////////////////////////////////////
-Pawn::Pawn(const uint8_t* bitBoard, bool black, int pawn_i)
-   : Piece(bitBoard, (black ? BLACK_START : WHITE_START) + (pawn_i * 2) + 1)
-   , m_PromotedIndex(black ? BLACK_PROMOTED : WHITE_PROMOTED)
-   , m_PromotedMask(1 << pawn_i)
-   , m_MoveDownward(black)
+void Pawn::AddMoves(int pos, uint64_t moveMask, MoveList& moves)
 {
-   
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Destructor
-///
-////////////////////////////////////////////////////////////////////////////////
-Pawn::~Pawn()
-{
-   
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Get the piece type as a string
-///
-////////////////////////////////////////////////////////////////////////////////
-std::string Pawn::Type() const
-{
-   if (Promoted())
+   for (; moveMask; moveMask &= moveMask - 1) // Pop the lowest position
    {
-      switch (PromotedType())
+      int targetPos = __builtin_ctzll(moveMask);
+      int row = Row(targetPos);
+      if (row == TOP_ROW || row == BOTTOM_ROW)
       {
-         case PROMOTED_TO_Q: return "Promoted Queen";
-         case PROMOTED_TO_R: return "Promoted Rook";
-         case PROMOTED_TO_B: return "Promoted Bishop";
-         case PROMOTED_TO_N: return "Promoted Knight";
-         default: EXIT("Unknown case"); return "";
+         moves.Add(pos, targetPos, true, PROMOTED_TO_Q);
+         moves.Add(pos, targetPos, true, PROMOTED_TO_R);
+         moves.Add(pos, targetPos, true, PROMOTED_TO_B);
+         moves.Add(pos, targetPos, true, PROMOTED_TO_N);
       }
-   }
-   else
-   {
-      return "Pawn";
-   }
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Get the value for the pawn (possibly promoted)
-///
-////////////////////////////////////////////////////////////////////////////////
-int Pawn::Value() const
-{
-   if (Promoted())
-   {
-      switch (PromotedType())
-      {
-         case PROMOTED_TO_Q: return Queen::VALUE;
-         case PROMOTED_TO_R: return Rook::VALUE;
-         case PROMOTED_TO_B: return Bishop::VALUE;
-         case PROMOTED_TO_N: return Knight::VALUE;
-         default: EXIT("Unknown case"); return 0;
-      }
-   }
-   else
-   {
-      return Pawn::VALUE;
-   }
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Check to see if the pawn has been promoted
-///
-////////////////////////////////////////////////////////////////////////////////
-bool Pawn::Promoted() const
-{
-   return m_BitBoard[m_PromotedIndex] & m_PromotedMask;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  What type of piece has the pawn been promoted to?
-///
-////////////////////////////////////////////////////////////////////////////////
-uint8_t Pawn::PromotedType() const
-{
-   return m_BitBoard[m_PosIndex] & PAWN_PROMOTE_MASK;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Check to see the piece is captured
-///
-////////////////////////////////////////////////////////////////////////////////
-bool Pawn::Captured() const
-{
-   return m_BitBoard[m_PosIndex - 1] & PAWN_CAPTURE_MASK;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Push actions for every move in the bit-mask
-///
-////////////////////////////////////////////////////////////////////////////////
-void Pawn::GetActions(int64_t moveMask, std::set<Action, std::greater<Action> >& actions) const
-{
-   ASSERT(!Captured());
-   if (Promoted())
-   {
-      Piece::GetActions(moveMask, actions);
-   }
-   else
-   {
-      for (int targetPos = 0; targetPos < 64; ++targetPos)
+      else
       {
-         if ((moveMask >> targetPos) & 1) // Position present in bit-mask?
-         {
-            int row = targetPos % (TOP_ROW + 1);
-            if (row == TOP_ROW || row == BOTTOM_ROW)
-            {
-               actions.emplace(Pos(), targetPos, Index(), true, PROMOTED_TO_Q);
-               actions.emplace(Pos(), targetPos, Index(), true, PROMOTED_TO_R);
-               actions.emplace(Pos(), targetPos, Index(), true, PROMOTED_TO_B);
-               actions.emplace(Pos(), targetPos, Index(), true, PROMOTED_TO_N);
-            }
-            else
-            {
-               actions.emplace(Pos(), targetPos, Index());
-            }
-         }
+         moves.Add(pos, targetPos);
       }
    }
 }
@@ -159,15 +36,15 @@ void Pawn::GetActions(int64_t moveMask, std::set<Action, std::greater<Action> >&
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Move the piece to its new position
+///   @brief  Move the pawn at the index to its new position
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void Pawn::Move(uint8_t* bitBoard, const Action& action) const
+void Pawn::Move(uint8_t* bitBoard, uint64_t& key, int index, const Action& action)
 {
-   Piece::Move(bitBoard, action);
+   Piece::Move(bitBoard, key, index, action);
    
    // If just a normal pawn that advanced two, set the en passant pos
-   if(!Promoted())
+   if (!(bitBoard[PromotedIndex(index)] & PromotedMask(index)))
    {
       if (action.end_pos + 2 == action.start_pos) // Move downward
       {
@@ -179,72 +56,58 @@ void Pawn::Move(uint8_t* bitBoard, const Action& action) const
          bitBoard[SPECIAL] |= (action.start_pos + 1) << POS_BITSHIFT;
          bitBoard[SPECIAL] |= EN_PASSANT_MASK;
       }
+      key ^= Zobrist::EnPassantKey(bitBoard); // Piece::Move cleared the old one
    }
    
    // Did the pawn just get promoted this turn?
    if (action.promoted)
    {
-      bitBoard[m_PromotedIndex] |= m_PromotedMask;
-      bitBoard[m_PosIndex] |= action.promoted_type;
+      key ^= Zobrist::PieceKey(bitBoard, index);
+      bitBoard[PromotedIndex(index)] |= PromotedMask(index);
+      bitBoard[index] |= action.promoted_type;
+      key ^= Zobrist::PieceKey(bitBoard, index);
    }
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Set the state of this piece to captured
+///   @brief  Set the state of the pawn at the index to captured
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void Pawn::SetCaptured(uint8_t* bitBoard) const
+void Pawn::SetCaptured(uint8_t* bitBoard, uint64_t& key, int index)
 {
-   bitBoard[m_PosIndex - 1] |= PAWN_CAPTURE_MASK;
+   key ^= Zobrist::PieceKey(bitBoard, index);
+   bitBoard[index - 1] |= PAWN_CAPTURE_MASK;
    
    // Clear the pos mask if testing (b/c easier to match with parsed fen)
    static Settings& settings = Settings::Instance();
    if (settings.test)
    {
-      bitBoard[m_PosIndex] &= CLEAR_POS_MASK;
+      bitBoard[index] &= CLEAR_POS_MASK;
    }
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Get a mask for the en passant position (if there is one)
+///   @brief  Get the index of the byte with the pawn's promoted flag
 ///
 ////////////////////////////////////////////////////////////////////////////////
-uint64_t Pawn::EnPassantMask() const
+int Pawn::PromotedIndex(int index)
 {
-   return (m_BitBoard[SPECIAL] & EN_PASSANT_MASK) ? Translate::PosToMask(m_BitBoard[SPECIAL] >> POS_BITSHIFT) : 0;
+   return (index < WHITE_START) ? BLACK_PROMOTED : WHITE_PROMOTED;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Represent all the moves a bishop can make as a bit mask
+///   @brief  Get the pawn's promoted flag
 ///
 ////////////////////////////////////////////////////////////////////////////////
-uint64_t Pawn::MoveMask(const PlayerMasks& playerMasks, const MaskOptions& maskOptions) const
+uint8_t Pawn::PromotedMask(int index)
 {
-   if (Captured())
-   {
-      return 0;
-   }
-   else if (Promoted())
-   {
-      switch (PromotedType())
-      {
-         case PROMOTED_TO_Q: return  Queen::__MoveMask(PosMask(), Row(), Col(), playerMasks, maskOptions);
-         case PROMOTED_TO_R: return   Rook::__MoveMask(PosMask(), Row(), Col(), playerMasks, maskOptions);
-         case PROMOTED_TO_B: return Bishop::__MoveMask(PosMask(), Row(), Col(), playerMasks, maskOptions);
-         case PROMOTED_TO_N: return Knight::__MoveMask(PosMask(), Row(), Col(), playerMasks, maskOptions);
-         default: EXIT("Unknown case"); return 0;
-      }
-   }
-   else
-   {
-      return Pawn::__MoveMask(playerMasks, maskOptions);
-   }
+   return 1 << ((index % WHITE_START) / 2);
 }
 
 
@@ -252,29 +115,31 @@ uint64_t Pawn::MoveMask(const PlayerMasks& playerMasks, const MaskOptions& maskO
 ///
 ///   @brief  Represent all the moves a pawn can make as a bit mask
 ///           - Consider en passant
-///           - Consider that the pawn could be promoted
+///           - A promoted pawn moves like the piece it was promoted to, so
+///             this is never called for one
 ///
 ////////////////////////////////////////////////////////////////////////////////
-uint64_t Pawn::__MoveMask(const PlayerMasks& playerMasks, const MaskOptions& maskOptions) const
+uint64_t Pawn::MoveMask(int pos, const PlayerMasks& playerMasks, const MaskOptions& maskOptions)
 {
    if (maskOptions.blockableKingAttack)
    {
       return 0;
    }
    
-   const uint64_t posMask = PosMask();
+   const uint64_t posMask = Translate::PosToMask(pos);
    const uint64_t emptySpaceMask = ~playerMasks.myPieces & ~playerMasks.theirPieces;
    uint64_t moveMask = 0;
    uint64_t captureMask = 0;
    
-   const int row = Row();
-   const int col = Col();
+   const int row = Row(pos);
+   const int col = Col(pos);
+   const bool moveDownward = playerMasks.black;
    
    // Skip these if we are only looking for king-threatening moves
    if (!maskOptions.throughKing)
    {
       // Move 1 space?
-      if (m_MoveDownward)
+      if (moveDownward)
       {
          moveMask |= posMask >> 1; // down 1
       }
@@ -287,7 +152,7 @@ uint64_t Pawn::__MoveMask(const PlayerMasks& playerMasks, const MaskOptions& mas
       // Move 2 spaces?
       if (moveMask)
       {
-         if (m_MoveDownward)
+         if (moveDownward)
          {
             if (row == TOP_PAWN_ROW)
             {
@@ -306,7 +171,7 @@ uint64_t Pawn::__MoveMask(const PlayerMasks& playerMasks, const MaskOptions& mas
    }
    
    // Capture?
-   if (m_MoveDownward)
+   if (moveDownward)
    {
       if (col > LEFT_COL)
       {
@@ -334,7 +199,7 @@ uint64_t Pawn::__MoveMask(const PlayerMasks& playerMasks, const MaskOptions& mas
    // look for pieces that pawn could guard, don't bother filtering...
    if (!maskOptions.guard)
    {
-      captureMask &= (playerMasks.theirPieces | EnPassantMask());
+      captureMask &= (playerMasks.theirPieces | playerMasks.enPassant);
    }
    
    return (moveMask | captureMask);
@@ -19,32 +19,18 @@
 class Pawn : public Piece
 {
 public:
+   static constexpr PieceType TYPE = PAWN;
    static const int VALUE = 1;
    
-   Pawn(const uint8_t* bitBoard, bool black, int pawn_i);
-   virtual ~Pawn();
+   static void AddMoves(int pos, uint64_t moveMask, MoveList& moves);
    
-   virtual std::string Type() const override;
-   virtual int Value() const override;
+   static void Move(uint8_t* bitBoard, uint64_t& key, int index, const Action& action);
+   static void SetCaptured(uint8_t* bitBoard, uint64_t& key, int index);
    
-   virtual bool Captured() const override;
-   virtual void GetActions(int64_t moveMask, std::set<Action, std::greater<Action> >& actions) const override;
-   
-   virtual void Move(uint8_t* bitBoard, const Action& action) const override;
-   virtual void SetCaptured(uint8_t* bitBoard) const override;
-   
-   uint64_t EnPassantMask() const override;
-   
-   virtual uint64_t MoveMask(const PlayerMasks& playerMasks, const MaskOptions& maskOptions = MaskOptions()) const override;
+   static uint64_t MoveMask(int pos, const PlayerMasks& playerMasks, const MaskOptions& maskOptions = MaskOptions());
    
 protected:
-   bool Promoted() const;
-   uint8_t PromotedType() const;
-   
-   uint64_t __MoveMask(const PlayerMasks& playerMasks, const MaskOptions& maskOptions) const;
-   
-   int m_PromotedIndex;
-   uint8_t m_PromotedMask;
-   bool m_MoveDownward;
+   static int PromotedIndex(int index);
+   static uint8_t PromotedMask(int index);
 };
 
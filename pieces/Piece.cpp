@@ -1,113 +1,100 @@
 
 
 #include "Piece.h"
+#include "King.h"
+#include "Queen.h"
+#include "Rook.h"
+#include "Bishop.h"
+#include "Knight.h"
+#include "Pawn.h"
 #include "ai/Settings.h"
 #include "io/Translate.h"
 #include "board/BitBoard.h"
+#include "board/Magic.h"
+#include "board/Zobrist.h"
 #include "io/Error.h"
 #include "io/Debug.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Constructor
+///   @brief  Get the piece type as a string
 ///
 ////////////////////////////////////////////////////////////////////////////////
-Piece::Piece(const uint8_t* bitBoard, int posIndex)
-   : m_BitBoard(bitBoard)
-   , m_PosIndex(posIndex)
+std::string Piece::Name(PieceType type)
 {
-   
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Destructor
-///
-////////////////////////////////////////////////////////////////////////////////
-Piece::~Piece()
-{
-   
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Get the unique index for the piece in the bit board
-///
-////////////////////////////////////////////////////////////////////////////////
-int Piece::Index() const
-{
-   return m_PosIndex;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Get the piece's [0, 64) position
-///
-////////////////////////////////////////////////////////////////////////////////
-int Piece::Pos() const
-{
-   ASSERT(!Captured());
-   return m_BitBoard[m_PosIndex] >> POS_BITSHIFT;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Translate the piece's position into a bit-mask if the piece
-///           is not captured
-///
-////////////////////////////////////////////////////////////////////////////////
-uint64_t Piece::PosMask() const
-{
-   return Captured() ? 0 : Translate::PosToMask(Pos());
+   switch (type)
+   {
+      case KING:   return "King";
+      case QUEEN:  return "Queen";
+      case ROOK:   return "Rook";
+      case BISHOP: return "Bishop";
+      case KNIGHT: return "Knight";
+      case PAWN:   return "Pawn";
+      default: EXIT("Unknown case"); return "";
+   }
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Check to see the piece is captured
+///   @brief  Get the value for a type of piece. Don't try to get the value
+///           of a king. Infinite would be suitable, but really it shouldn't
+///           be compared to other pieces.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-bool Piece::Captured() const
+int Piece::Value(PieceType type)
 {
-   return m_BitBoard[m_PosIndex] & BIG_CAPTURE_MASK;
+   switch (type)
+   {
+      case QUEEN:  return Queen::VALUE;
+      case ROOK:   return Rook::VALUE;
+      case BISHOP: return Bishop::VALUE;
+      case KNIGHT: return Knight::VALUE;
+      case PAWN:   return Pawn::VALUE;
+      case KING: EXIT("Shouldn't be trying to retrieve the king's value"); return 0;
+      default: EXIT("Unknown case"); return 0;
+   }
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Push actions for every move in the bit-mask
+///   @brief  Represent all the moves a type of piece can make as a bit mask,
+///           when the type is only known at run time
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void Piece::GetActions(int64_t moveMask, std::set<Action, std::greater<Action> >& actions) const
+uint64_t Piece::MoveMask(PieceType type, int pos, const PlayerMasks& playerMasks, const MaskOptions& maskOptions)
 {
-   ASSERT(!Captured());
-   for (int targetPos = 0; targetPos < 64; ++targetPos)
+   switch (type)
    {
-      if ((moveMask >> targetPos) & 1) // Position present in bit-mask?
-      {
-         actions.emplace(Pos(), targetPos, Index());
-      }
+      case KING:   return   King::MoveMask(pos, playerMasks, maskOptions);
+      case QUEEN:  return  Queen::MoveMask(pos, playerMasks, maskOptions);
+      case ROOK:   return   Rook::MoveMask(pos, playerMasks, maskOptions);
+      case BISHOP: return Bishop::MoveMask(pos, playerMasks, maskOptions);
+      case KNIGHT: return Knight::MoveMask(pos, playerMasks, maskOptions);
+      case PAWN:   return   Pawn::MoveMask(pos, playerMasks, maskOptions);
+      default: EXIT("Unknown case"); return 0;
    }
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Move the piece to its new position
+///   @brief  Move the piece at the index to its new position
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void Piece::Move(uint8_t* bitBoard, const Action& action) const
+void Piece::Move(uint8_t* bitBoard, uint64_t& key, int index, const Action& action)
 {
-   ASSERT(!Captured());
+   ASSERT_NE(NUM_PIECE_TYPES, GetType(bitBoard, index));
+   
+   // Take the old position and en passant out of the key
+   key ^= Zobrist::PieceKey(bitBoard, index) ^ Zobrist::EnPassantKey(bitBoard);
    
    // Apply the position
-   bitBoard[m_PosIndex] &= CLEAR_POS_MASK;
-   bitBoard[m_PosIndex] |= action.end_pos << POS_BITSHIFT;
+   bitBoard[index] &= CLEAR_POS_MASK;
+   bitBoard[index] |= action.end_pos << POS_BITSHIFT;
+   key ^= Zobrist::PieceKey(bitBoard, index);
    
    // Clear the en passant pos mask and flag
    bitBoard[SPECIAL] &= CLEAR_POS_MASK;
@@ -117,107 +104,89 @@ void Piece::Move(uint8_t* bitBoard, const Action& action) const
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Set the state of this piece to captured
+///   @brief  Set the state of the piece at the index to captured
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void Piece::SetCaptured(uint8_t* bitBoard) const
+void Piece::SetCaptured(uint8_t* bitBoard, uint64_t& key, int index)
 {
-   bitBoard[m_PosIndex] |= BIG_CAPTURE_MASK;
+   key ^= Zobrist::PieceKey(bitBoard, index);
+   bitBoard[index] |= BIG_CAPTURE_MASK;
    
    // Clear the pos mask if testing (b/c easier to match with parsed fen)
    static Settings& settings = Settings::Instance();
    if (settings.test)
    {
-      bitBoard[m_PosIndex] &= CLEAR_POS_MASK;
+      bitBoard[index] &= CLEAR_POS_MASK;
    }
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Doesn't make sense for anything but a pawn, so just return 0
+///   @brief  Get the occupancy a sliding piece should be blocked by. If
+///           'throughKing' is specified, their king doesn't block anything.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-uint64_t Piece::EnPassantMask() const
+uint64_t Piece::SliderOccupancy(const PlayerMasks& playerMasks, const MaskOptions& maskOptions)
 {
-   return 0;
+   uint64_t occupied = playerMasks.myPieces | playerMasks.theirPieces;
+   if (maskOptions.throughKing)
+   {
+      occupied &= ~playerMasks.theirKing;
+   }
+   return occupied;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  The the row index for the current position
-///
-////////////////////////////////////////////////////////////////////////////////
-int Piece::Row() const
-{
-   return Pos() % (TOP_ROW + 1);
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
+///   @brief  Get the pieces a sliding piece can see through if
+///           'throughNotKingOnce' is specified, i.e. the first piece of
+///           theirs (other than the king) it runs into in each direction
 ///
-///   @brief  The the col index for the current position
+///   @param attacks  The attacks for the slider with nothing removed from
+///                   the occupancy
 ///
 ////////////////////////////////////////////////////////////////////////////////
-int Piece::Col() const
+uint64_t Piece::XRayBlockers(uint64_t attacks, const PlayerMasks& playerMasks)
 {
-   return Pos() / (RIGHT_COL + 1);
+   return attacks & playerMasks.theirPieces & ~playerMasks.theirKing;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Apply the position to the moves bit-mask. If 'guard' is
-///           specified, apply it even if the pos is also occupied by another
-///           one of our pieces.
+///   @brief  Apply the rest of the options to the attacks of a sliding
+///           piece.
 ///
-///   @return  true if the position didn't match one of my pieces or their
-///            pieces or if this is their king and we are attacking through it
+///           Unless 'guard' is specified, drop the squares occupied by my
+///           pieces.
+///
+///           If we are looking for a king attack that can be blocked (i.e. an
+///           attack from a Queen / Rook / Bishop) keep only the direction
+///           that reaches their king, minus the king itself. If no direction
+///           reaches it, there is no attack.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-bool Piece::ApplyPosToMask(uint64_t& moveMask, uint64_t posMask, int& through, const PlayerMasks& playerMasks, const MaskOptions& maskOptions)
+uint64_t Piece::ApplySliderOptions(int pos, uint64_t moveMask, const PlayerMasks& playerMasks, const MaskOptions& maskOptions)
 {
-   bool myPiece = (posMask & playerMasks.myPieces);
-   bool theirPiece = (posMask & playerMasks.theirPieces);
-   bool theirKing = (posMask & playerMasks.theirKing);
-   bool throughKing = (theirKing && maskOptions.throughKing);
-   bool throughNotKing = (theirPiece && !theirKing && maskOptions.throughNotKingOnce && ++through <= 1);
-   
-   if (!myPiece || maskOptions.guard)
+   if (!maskOptions.guard)
    {
-      moveMask |= posMask;
+      moveMask &= ~playerMasks.myPieces;
    }
-   return (!myPiece && !theirPiece) || throughKing || throughNotKing;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  If we are looking for a king attack that can be blocked (i.e. an
-///           attack from a Queen / Rook / Bishop)...
-///           
-///           Omit the target king from the bit mask if we find it, but reset
-///           the bit mask if we don't find it.
-///
-///   @return  true if we found the attack bitmap we are looking for
-///
-////////////////////////////////////////////////////////////////////////////////
-bool Piece::FindBlockableKingAttack(uint64_t& moveMask, const PlayerMasks& playerMasks, const MaskOptions& maskOptions)
-{
    if (maskOptions.blockableKingAttack)
    {
       if (moveMask & playerMasks.theirKing)
       {
+         moveMask &= Magic::Ray(pos, Translate::MaskToPos(playerMasks.theirKing));
          moveMask &= ~playerMasks.theirKing;
-         return true;
       }
       else
       {
          moveMask = 0;
       }
    }
-   return false;
+   return moveMask;
 }
 
 
@@ -227,12 +196,16 @@ bool Piece::FindBlockableKingAttack(uint64_t& moveMask, const PlayerMasks& playe
 ///
 /////////////////////////////////////////////////////////////////////////////
 Piece::PlayerMasks::PlayerMasks(uint64_t myPieces, uint64_t theirPieces, uint64_t theirMoves,
-                                uint64_t theirKing, uint64_t myKingsDangerSquares)
+                                uint64_t theirKing, uint64_t myKingsDangerSquares,
+                                bool black, uint64_t enPassant, uint8_t castleRights)
    : myPieces(myPieces)
    , theirPieces(theirPieces)
    , theirMoves(theirMoves)
    , theirKing(theirKing)
    , myKingsDangerSquares(myKingsDangerSquares)
+   , black(black)
+   , enPassant(enPassant)
+   , castleRights(castleRights)
 {
    
 }
@@ -250,6 +223,9 @@ void Piece::PlayerMasks::Clear()
    theirMoves = 0;
    theirKing = 0;
    myKingsDangerSquares = 0;
+   black = false;
+   enPassant = 0;
+   castleRights = 0;
 }
 
 
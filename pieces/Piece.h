@@ -1,9 +1,10 @@
 #pragma once
 
 #include "ai/Action.h"
+#include "ai/MoveList.h"
+#include "board/BitBoard.h"
 #include <cstdint>
 #include <string>
-#include <set>
 
 static constexpr int TOP_ROW         = 7;
 static constexpr int TOP_PAWN_ROW    = 6;
@@ -13,29 +14,43 @@ static constexpr int BOTTOM_ROW      = 0;
 static constexpr int LEFT_COL  = 0;
 static constexpr int RIGHT_COL = 7;
 
+// Kinds of piece (a promoted pawn is whatever it was promoted to)
+enum PieceType { KING, QUEEN, ROOK, BISHOP, KNIGHT, PAWN, NUM_PIECE_TYPES };
+
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  A simple base class for pieces
 ///
+///           Pieces are never instantiated. Each piece class is a set of
+///           static functions for one type of piece (its move mask, how it
+///           updates the bit board when it moves or is captured), so the
+///           board can pick them at compile time instead of through a
+///           virtual call. Everything is looked up by the piece's index in
+///           the bit board.
+///
 ////////////////////////////////////////////////////////////////////////////////
 class Piece
 {
 public:
-   
+
    // Helper class to store all the masks needed to generate piece move masks
    struct PlayerMasks
    {
       PlayerMasks(uint64_t myPieces = 0, uint64_t theirPieces = 0, uint64_t theirMoves = 0,
-                  uint64_t theirKing = 0, uint64_t myKingsDangerSquares = 0);
+                  uint64_t theirKing = 0, uint64_t myKingsDangerSquares = 0,
+                  bool black = false, uint64_t enPassant = 0, uint8_t castleRights = 0);
       void Clear();
       uint64_t myPieces;
       uint64_t theirPieces;
       uint64_t theirMoves;
       uint64_t theirKing;
       uint64_t myKingsDangerSquares;
+      bool black;           // Which way the pawns move
+      uint64_t enPassant;   // Pawns can capture here too
+      uint8_t castleRights; // R1_CASTLE_MASK / R2_CASTLE_MASK bits still set
    };
-   
+
    // Helper class to store options used when generating move masks
    struct MaskOptions
    {
@@ -47,37 +62,100 @@ public:
       bool throughNotKingOnce;
       bool skipKing;
    };
-   
-   Piece(const uint8_t* bitBoard, int posIndex);
-   virtual ~Piece();
-   
-   int Index() const;
-   int Pos() const;
-   uint64_t PosMask() const;
-   
-   virtual std::string Type() const = 0;   
-   virtual int Value() const = 0;
-   
-   // pawn should override these
-   virtual bool Captured() const;
-   virtual void GetActions(int64_t moveMask, std::set<Action, std::greater<Action> >& actions) const;
-   
-   virtual void Move(uint8_t* bitBoard, const Action& action) const;
-   virtual void SetCaptured(uint8_t* bitBoard) const;
-   
-   virtual uint64_t EnPassantMask() const;
-   
-   // every piece overrides this (should return 0 if captured)
-   virtual uint64_t MoveMask(const PlayerMasks& playerMasks, const MaskOptions& maskOptions = MaskOptions()) const = 0;
-   
+
+   static PieceType GetType(const uint8_t* bitBoard, int index);
+   static int Pos(const uint8_t* bitBoard, int index);
+   static std::string Name(PieceType type);
+   static int Value(PieceType type);
+   static uint64_t MoveMask(PieceType type, int pos, const PlayerMasks& playerMasks, const MaskOptions& maskOptions = MaskOptions());
+
+   static void AddMoves(int pos, uint64_t moveMask, MoveList& moves);
+   static void Move(uint8_t* bitBoard, uint64_t& key, int index, const Action& action);
+   static void SetCaptured(uint8_t* bitBoard, uint64_t& key, int index);
+
 protected:
-   int Row() const;
-   int Col() const;
-   
-   static bool ApplyPosToMask(uint64_t& moveMask, uint64_t posMask, int& through, const PlayerMasks& playerMasks, const MaskOptions& maskOptions);
-   static bool FindBlockableKingAttack(uint64_t& moveMask, const PlayerMasks& playerMasks, const MaskOptions& maskOptions);
-   
-   const uint8_t* m_BitBoard;
-   const int m_PosIndex;
+   static int Row(int pos);
+   static int Col(int pos);
+
+   static uint64_t SliderOccupancy(const PlayerMasks& playerMasks, const MaskOptions& maskOptions);
+   static uint64_t XRayBlockers(uint64_t attacks, const PlayerMasks& playerMasks);
+   static uint64_t ApplySliderOptions(int pos, uint64_t moveMask, const PlayerMasks& playerMasks, const MaskOptions& maskOptions);
 };
 
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Work out what type of piece is at the index in the bit board,
+///           accounting for promoted pawns
+///
+///   @return  The type of piece, or NUM_PIECE_TYPES if it is captured
+///
+////////////////////////////////////////////////////////////////////////////////
+inline PieceType Piece::GetType(const uint8_t* bitBoard, int index)
+{
+   static const PieceType BIG_TYPES[8] = {KING, QUEEN, ROOK, ROOK, BISHOP, BISHOP, KNIGHT, KNIGHT};
+   static const PieceType PROMOTED_TYPES[4] = {QUEEN, ROOK, BISHOP, KNIGHT}; // PROMOTED_TO_*
+
+   int slot = index % WHITE_START;
+   if (slot % 2 == 0) // King, queen, rook, bishop or knight
+   {
+      return (bitBoard[index] & BIG_CAPTURE_MASK) ? NUM_PIECE_TYPES : BIG_TYPES[slot / 2];
+   }
+   else if (bitBoard[index - 1] & PAWN_CAPTURE_MASK)
+   {
+      return NUM_PIECE_TYPES;
+   }
+   else if (bitBoard[index < WHITE_START ? BLACK_PROMOTED : WHITE_PROMOTED] & (1 << (slot / 2)))
+   {
+      return PROMOTED_TYPES[bitBoard[index] & PAWN_PROMOTE_MASK];
+   }
+   return PAWN;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the [0, 64) position of the piece at the index
+///
+////////////////////////////////////////////////////////////////////////////////
+inline int Piece::Pos(const uint8_t* bitBoard, int index)
+{
+   return bitBoard[index] >> POS_BITSHIFT;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Push actions for every move in the bit-mask
+///
+////////////////////////////////////////////////////////////////////////////////
+inline void Piece::AddMoves(int pos, uint64_t moveMask, MoveList& moves)
+{
+   for (; moveMask; moveMask &= moveMask - 1) // Pop the lowest position
+   {
+      moves.Add(pos, __builtin_ctzll(moveMask));
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The the row index for the position
+///
+////////////////////////////////////////////////////////////////////////////////
+inline int Piece::Row(int pos)
+{
+   return pos % (TOP_ROW + 1);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The the col index for the position
+///
+////////////////////////////////////////////////////////////////////////////////
+inline int Piece::Col(int pos)
+{
+   return pos / (RIGHT_COL + 1);
+}
+
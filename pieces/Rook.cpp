@@ -2,187 +2,70 @@
 
 #include "Rook.h"
 #include "board/BitBoard.h"
+#include "board/Magic.h"
+#include "board/Zobrist.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Constructor
+///   @brief  Move the rook at the index to its new position
 ///
 ////////////////////////////////////////////////////////////////////////////////
-Rook::Rook(const uint8_t* bitBoard, bool black, int rook_i)
-   : Piece(bitBoard, (black ? BLACK_START : WHITE_START) + (rook_i == 0 ? R1_INDEX : R2_INDEX))
-   , m_CastleBitshift(black ? BLACK_CASTLE_BITSHIFT : WHITE_CASTLE_BITSHIFT)
-   , m_CastleMask(rook_i == 0 ? R1_CASTLE_MASK : R2_CASTLE_MASK)
+void Rook::Move(uint8_t* bitBoard, uint64_t& key, int index, const Action& action)
 {
-   
+   Piece::Move(bitBoard, key, index, action);
+   ClearCastle(bitBoard, key, index);
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Destructor
+///   @brief  Set the state of the rook at the index to captured
 ///
 ////////////////////////////////////////////////////////////////////////////////
-Rook::~Rook()
+void Rook::SetCaptured(uint8_t* bitBoard, uint64_t& key, int index)
 {
-   
+   Piece::SetCaptured(bitBoard, key, index);
+   ClearCastle(bitBoard, key, index);
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
-///   @brief  Get the piece type as a string
+///   @brief  The king can't castle with the rook at the index any more (if
+///           it still could)
 ///
 ////////////////////////////////////////////////////////////////////////////////
-std::string Rook::Type() const
+void Rook::ClearCastle(uint8_t* bitBoard, uint64_t& key, int index)
 {
-   return "Rook";
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Get the value for the rook
-///
-////////////////////////////////////////////////////////////////////////////////
-int Rook::Value() const
-{
-   return Rook::VALUE;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Move the piece to its new position
-///
-////////////////////////////////////////////////////////////////////////////////
-void Rook::Move(uint8_t* bitBoard, const Action& action) const
-{
-   Piece::Move(bitBoard, action);
-   if (CastleAvailable())
-   {
-      bitBoard[CASTLE_INDEX] &= ~(m_CastleMask << m_CastleBitshift);
-   }
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Set the state of this piece to captured
-///
-////////////////////////////////////////////////////////////////////////////////
-void Rook::SetCaptured(uint8_t* bitBoard) const
-{
-   Piece::SetCaptured(bitBoard);
-   if (CastleAvailable())
+   int castleBitshift = (index < WHITE_START) ? BLACK_CASTLE_BITSHIFT : WHITE_CASTLE_BITSHIFT;
+   uint8_t castleMask = (index % WHITE_START == R1_INDEX) ? R1_CASTLE_MASK : R2_CASTLE_MASK;
+   if ((bitBoard[CASTLE_INDEX] >> castleBitshift) & castleMask)
    {
-      bitBoard[CASTLE_INDEX] &= ~(m_CastleMask << m_CastleBitshift);
+      key ^= Zobrist::CastleKey(bitBoard);
+      bitBoard[CASTLE_INDEX] &= ~(castleMask << castleBitshift);
+      key ^= Zobrist::CastleKey(bitBoard);
    }
 }
 
 
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Check to see if the king has moved or this rook has moved
-///
-////////////////////////////////////////////////////////////////////////////////
-bool Rook::CastleAvailable() const
-{
-   return (m_BitBoard[CASTLE_INDEX] >> m_CastleBitshift) & m_CastleMask;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-///
-///   @brief  Represent all the moves a bishop can make as a bit mask
-///
-////////////////////////////////////////////////////////////////////////////////
-uint64_t Rook::MoveMask(const PlayerMasks& playerMasks, const MaskOptions& maskOptions) const
-{
-   return Captured() ? 0 : __MoveMask(PosMask(), Row(), Col(), playerMasks, maskOptions);
-}
-
-
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  Represent all the moves a rook can make as a bit mask
 ///
+///           The attacks come straight from the magic tables. Normally we
+///           don't move through pieces, but if the options tell us to we
+///           look up the attacks again with those pieces removed.
+///
 ////////////////////////////////////////////////////////////////////////////////
-uint64_t Rook::__MoveMask(uint64_t posMask, int row, int col, const PlayerMasks& playerMasks, const MaskOptions& maskOptions)
+uint64_t Rook::MoveMask(int pos, const PlayerMasks& playerMasks, const MaskOptions& maskOptions)
 {
-   uint64_t moveMask = 0;
-   
-   int i;
-   
-   // Normally we don't move through pieces, but if the options tell us to
-   // we have to count them in at least one case
-   int through;
-   
-   // Left
-   through = 0;
-   for (i = col - 1; i >= LEFT_COL; --i)
-   {
-      uint64_t left = posMask >> ((col - i) * 8); // left 1, 2, ...
-      if (!ApplyPosToMask(moveMask, left, through, playerMasks, maskOptions))
-      {
-         break;
-      }
-   }
-   
-   // Attacking a king to the left?
-   if (FindBlockableKingAttack(moveMask, playerMasks, maskOptions))
-   {
-      return moveMask;
-   }
-   
-   // Right
-   through = 0;
-   for (i = col + 1; i <= RIGHT_COL; ++i)
-   {
-      uint64_t right = posMask << ((i - col) * 8); // right 1, 2, ...
-      if (!ApplyPosToMask(moveMask, right, through, playerMasks, maskOptions))
-      {
-         break;
-      }
-   }
-   
-   // Attacking a king to the right?
-   if (FindBlockableKingAttack(moveMask, playerMasks, maskOptions))
-   {
-      return moveMask;
-   }
-   
-   // Up
-   through = 0;
-   for (i = row + 1; i <= TOP_ROW; ++i)
-   {
-      uint64_t up = posMask << (i - row); // up 1, 2, ...
-      if (!ApplyPosToMask(moveMask, up, through, playerMasks, maskOptions))
-      {
-         break;
-      }
-   }
-   
-   // Attacking a king above?
-   if (FindBlockableKingAttack(moveMask, playerMasks, maskOptions))
-   {
-      return moveMask;
-   }
-   
-   // Down
-   through = 0;
-   for (i = row - 1; i >= BOTTOM_ROW; --i)
+   uint64_t occupied = SliderOccupancy(playerMasks, maskOptions);
+   uint64_t moveMask = Magic::RookAttacks(pos, occupied);
+   if (maskOptions.throughNotKingOnce)
    {
-      uint64_t down = posMask >> (row - i); // down 1, 2, ...
-      if (!ApplyPosToMask(moveMask, down, through, playerMasks, maskOptions))
-      {
-         break;
-      }
+      moveMask = Magic::RookAttacks(pos, occupied & ~XRayBlockers(moveMask, playerMasks));
    }
-   
-   // Attacking a king below?
-   FindBlockableKingAttack(moveMask, playerMasks, maskOptions);
-   
-   return moveMask;
+   return ApplySliderOptions(pos, moveMask, playerMasks, maskOptions);
 }
 
@@ -12,24 +12,15 @@
 class Rook : public Piece
 {
 public:
+   static constexpr PieceType TYPE = ROOK;
    static const int VALUE = 5;
    
-   Rook(const uint8_t* bitBoard, bool black, int rook_i);
-   virtual ~Rook();
+   static void Move(uint8_t* bitBoard, uint64_t& key, int index, const Action& action);
+   static void SetCaptured(uint8_t* bitBoard, uint64_t& key, int index);
    
-   virtual std::string Type() const override;
-   virtual int Value() const override;
-   
-   virtual void Move(uint8_t* bitBoard, const Action& action) const override;
-   virtual void SetCaptured(uint8_t* bitBoard) const override;
-   
-   virtual uint64_t MoveMask(const PlayerMasks& playerMasks, const MaskOptions& maskOptions = MaskOptions()) const override;
-   static uint64_t __MoveMask(uint64_t posMask, int row, int col, const PlayerMasks& playerMasks, const MaskOptions& maskOptions);
+   static uint64_t MoveMask(int pos, const PlayerMasks& playerMasks, const MaskOptions& maskOptions = MaskOptions());
    
 protected:
-   bool CastleAvailable() const;
-   
-   int m_CastleBitshift;
-   uint8_t m_CastleMask;
+   static void ClearCastle(uint8_t* bitBoard, uint64_t& key, int index);
 };
 
@@ -0,0 +1,301 @@
+#include "AiHelperTester.h"
+#include "ai/AiHelper.h"
+#include "ai/SearchContext.h"
+#include "ai/Settings.h"
+#include "ai/State.h"
+#include "ai/Timer.h"
+#include "ai/TranspositionTable.h"
+#include "io/Error.h"
+#include "io/Translate.h"
+#include <memory>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Run all the tests
+///
+////////////////////////////////////////////////////////////////////////////////
+void AiHelperTester::RunTests()
+{
+   test_PvsMatchesAlphaBeta();
+   test_PvsSearchesFewerNodes();
+   test_Quiescence();
+   test_PruningSearchesFewerNodes();
+   test_PruningFindsMates();
+   test_ExtensionsFindMates();
+   test_Draws();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The null and aspiration windows should only prune, never change
+///           the value found (without the table, so nothing else can)
+///
+////////////////////////////////////////////////////////////////////////////////
+void AiHelperTester::test_PvsMatchesAlphaBeta()
+{
+   static const char* POSITIONS[] = {
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+      "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+      "4k3/8/8/3q4/8/8/3Q4/3K4 b - - 0 1", // Trade queens (the value jumps)
+   };
+   
+   Settings& settings = Settings::Instance();
+   Settings saved = settings;
+   settings.alpha_beta = true;
+   settings.history_table = true;
+   TranspositionTable::Instance().Resize(0);
+   
+   for (const char* fen : POSITIONS)
+   {
+      uint64_t nodes = 0;
+      ASSERT_EQ(Search(fen, 3, false, nodes), Search(fen, 3, true, nodes));
+   }
+   
+   settings = saved;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  With the table to order the moves, most null window searches
+///           should hold, so fewer nodes are searched
+///
+////////////////////////////////////////////////////////////////////////////////
+void AiHelperTester::test_PvsSearchesFewerNodes()
+{
+   static const char* POSITIONS[] = {
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+      "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+   };
+   
+   Settings& settings = Settings::Instance();
+   Settings saved = settings;
+   settings.alpha_beta = true;
+   settings.history_table = true;
+   TranspositionTable::Instance().Resize(1);
+   
+   uint64_t totalAlphaBeta = 0;
+   uint64_t totalPvs = 0;
+   for (const char* fen : POSITIONS)
+   {
+      uint64_t nodes = 0;
+      TranspositionTable::Instance().Clear();
+      Search(fen, 4, false, nodes);
+      totalAlphaBeta += nodes;
+      TranspositionTable::Instance().Clear();
+      Search(fen, 4, true, nodes);
+      totalPvs += nodes;
+   }
+   ASSERT_LT(totalPvs, totalAlphaBeta);
+   
+   TranspositionTable::Instance().Resize(0);
+   settings = saved;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Without a quiescence search, the queen takes a guarded pawn at
+///           the depth limit. With one, the recapture is seen.
+///
+////////////////////////////////////////////////////////////////////////////////
+void AiHelperTester::test_Quiescence()
+{
+   static const char* GUARDED_PAWN = "4k3/8/4p3/3p4/8/8/8/3QK3 w - - 0 1";
+   
+   Settings& settings = Settings::Instance();
+   Settings saved = settings;
+   settings.alpha_beta = true;
+   settings.max_depth_limit = 1;
+   
+   const int d5 = Translate::AlgebraicStrToPos("d5");
+   const HVal material = State(GUARDED_PAWN).MaterialBalance() * hval::PAWN; // Already at the root
+   for (bool quiescent : {false, true})
+   {
+      settings.quiescent = quiescent;
+      std::unique_ptr<SearchContext> pContext(new SearchContext());
+      Timer::Instance().Restart();
+      Action action = AiHelper::ID_DL_MiniMax(*pContext, State(GUARDED_PAWN));
+      if (quiescent)
+      {
+         ASSERT_NE(d5, action.end_pos);
+         ASSERT_LT(pContext->bestAction.first - material, hval::PAWN);
+      }
+      else
+      {
+         ASSERT_EQ(d5, action.end_pos);
+         ASSERT_GE(pContext->bestAction.first - material, hval::PAWN);
+      }
+   }
+   
+   settings = saved;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Null-move pruning and late move reductions should each cut the
+///           nodes searched to the same depth
+///
+////////////////////////////////////////////////////////////////////////////////
+void AiHelperTester::test_PruningSearchesFewerNodes()
+{
+   static const char* POSITIONS[] = {
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+   };
+   
+   Settings& settings = Settings::Instance();
+   Settings saved = settings;
+   settings.alpha_beta = true;
+   settings.history_table = true;
+   settings.quiescent = true;
+   TranspositionTable::Instance().Resize(1);
+   
+   uint64_t totals[3] = {0, 0, 0}; // Neither, null move, both
+   for (const char* fen : POSITIONS)
+   {
+      for (int i = 0; i < 3; ++i)
+      {
+         settings.null_move = (i >= 1);
+         settings.lmr = (i >= 2);
+         uint64_t nodes = 0;
+         TranspositionTable::Instance().Clear();
+         Search(fen, 5, true, nodes);
+         totals[i] += nodes;
+      }
+   }
+   ASSERT_LT(totals[1], totals[0]);
+   ASSERT_LT(totals[2], totals[1]);
+   
+   TranspositionTable::Instance().Resize(0);
+   settings = saved;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The pruning shouldn't hide a forced mate, even one that starts
+///           with a quiet action or a sacrifice
+///
+////////////////////////////////////////////////////////////////////////////////
+void AiHelperTester::test_PruningFindsMates()
+{
+   static const char* MATES_IN_2[] = {
+      "kbK5/pp6/1P6/8/8/8/8/R7 w - - 0 1",
+      "r1bq2r1/b4pk1/p1pp1p2/1p2pP2/1P2P1PB/3P4/1PPQ2P1/R3K2R w - - 0 1",
+   };
+   
+   Settings& settings = Settings::Instance();
+   Settings saved = settings;
+   settings.alpha_beta = true;
+   settings.history_table = true;
+   settings.quiescent = true;
+   settings.null_move = true;
+   settings.lmr = true;
+   
+   for (const char* fen : MATES_IN_2)
+   {
+      uint64_t nodes = 0;
+      ASSERT_EQ(hval::MATE - 3, Search(fen, 5, true, nodes));
+   }
+   
+   settings = saved;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A smothered mate in five is all checks and forced replies, so
+///           with extensions a search to depth 4 sees all 9 plies of it
+///
+////////////////////////////////////////////////////////////////////////////////
+void AiHelperTester::test_ExtensionsFindMates()
+{
+   static const char* SMOTHERED = "5rk1/6pp/8/6N1/8/8/8/K2Q4 w - - 0 1";
+   
+   Settings& settings = Settings::Instance();
+   Settings saved = settings;
+   settings.alpha_beta = true;
+   settings.history_table = true;
+   settings.quiescent = true;
+   settings.null_move = true;
+   settings.lmr = true;
+   
+   for (bool extensions : {false, true})
+   {
+      settings.extensions = extensions;
+      uint64_t nodes = 0;
+      HVal value = Search(SMOTHERED, 4, true, nodes);
+      if (extensions)
+      {
+         ASSERT_EQ(hval::MATE - 9, value);
+      }
+      else
+      {
+         ASSERT(!hval::IsMate(value));
+      }
+   }
+   
+   settings = saved;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A mate that takes a quiet move first is only a draw by the 50
+///           move rule, but a mate on the 100th half move is still a mate.
+///           A state from before the root has to repeat twice to be a draw;
+///           one from the search only has to repeat once.
+///
+////////////////////////////////////////////////////////////////////////////////
+void AiHelperTester::test_Draws()
+{
+   Settings& settings = Settings::Instance();
+   Settings saved = settings;
+   settings.alpha_beta = true;
+   
+   uint64_t nodes = 0;
+   ASSERT_EQ(hval::MATE - 3, Search("k7/8/2K5/8/8/8/8/7R w - - 0 1", 4, false, nodes));
+   ASSERT_EQ(0, Search("k7/8/2K5/8/8/8/8/7R w - - 99 80", 4, false, nodes));
+   ASSERT_EQ(hval::MATE - 1, Search("k7/8/1K6/8/8/8/8/7R w - - 99 80", 2, false, nodes));
+   
+   std::unique_ptr<SearchContext> pContext(new SearchContext());
+   SearchContext& context = *pContext;
+   context.keys = {2, 7, 3, 7, 2, 7};
+   ASSERT(!context.Repetition(7, 6, 6)); // Not with the same turn player
+   ASSERT(!context.Repetition(3, 6, 1)); // Only once before the root
+   ASSERT(context.Repetition(3, 6, 4)); // Once since the root
+   ASSERT(context.Repetition(2, 6, 1)); // Twice before the root
+   ASSERT(!context.Repetition(2, 4, 1)); // The second is before a pawn move or capture
+   
+   settings = saved;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Search the position to the depth (from a new context)
+///
+///   @param nodes  Populated with the number of nodes searched
+///
+///   @return  The value of the best action
+///
+////////////////////////////////////////////////////////////////////////////////
+HVal AiHelperTester::Search(const char* fen, int depth, bool pvs, uint64_t& nodes)
+{
+   Settings& settings = Settings::Instance();
+   settings.pvs = pvs;
+   settings.max_depth_limit = depth;
+   
+   std::unique_ptr<SearchContext> pContext(new SearchContext());
+   Timer::Instance().Restart();
+   AiHelper::ID_DL_MiniMax(*pContext, State(fen));
+   nodes = pContext->nodes;
+   return pContext->bestAction.first;
+}
+
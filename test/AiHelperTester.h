@@ -0,0 +1,28 @@
+#pragma once
+
+#include "ai/HeuristicValue.h"
+#include <cstdint>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A class for testing the search
+///
+////////////////////////////////////////////////////////////////////////////////
+class AiHelperTester
+{
+public:
+   static void RunTests();
+   
+protected:
+   static void test_PvsMatchesAlphaBeta();
+   static void test_PvsSearchesFewerNodes();
+   static void test_Quiescence();
+   static void test_PruningSearchesFewerNodes();
+   static void test_PruningFindsMates();
+   static void test_ExtensionsFindMates();
+   static void test_Draws();
+   
+   static HVal Search(const char* fen, int depth, bool pvs, uint64_t& nodes);
+};
+
@@ -1,7 +1,7 @@
 
 
 #include "BitBoardTester.h"
-#include "board/Board/BitBoard.h"
+#include "board/BitBoard.h"
 #include "io/Error.h"
 #include <bitset>
 #include <cstdlib>
@@ -31,6 +31,8 @@ void BoardTester::RunTests()
    test_Fen2_KingMoves();
    test_Fen3_PawnMoves();
    test_Fen4_BishopMoves();
+   test_MakeUnmake();
+   test_NullMove();
 }
 
 
@@ -385,6 +387,141 @@ void BoardTester::test_Fen4_BishopMoves()
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Walk the move tree of some positions with castling, en passant
+///           and promotions using make/unmake. Every node should match a
+///           board that was reset to the same bit board, and every unmake
+///           should put the board back the way it was.
+///
+////////////////////////////////////////////////////////////////////////////////
+void BoardTester::test_MakeUnmake()
+{
+   static const std::string KIWIPETE = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+   static const std::string PROMOTE  = "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1";
+   static const std::string EP_PINS  = "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1";
+   
+   MyBoard board;
+   MyBoard reference;
+   
+   board.SetBitBoard(MyState(KIWIPETE).m_BitBoard);
+   ASSERT_EQ(2039, MakeUnmake(board, reference, 2));
+   ASSERT_EQ(0, board.NumMovesMade());
+   
+   board.SetBitBoard(MyState(PROMOTE).m_BitBoard);
+   ASSERT_EQ(9467, MakeUnmake(board, reference, 3));
+   ASSERT_EQ(0, board.NumMovesMade());
+   
+   board.SetBitBoard(MyState(EP_PINS).m_BitBoard);
+   ASSERT_EQ(43238, MakeUnmake(board, reference, 4));
+   ASSERT_EQ(0, board.NumMovesMade());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A null move should only pass the turn (and lose the en passant
+///           capture), and taking it back should restore everything
+///
+////////////////////////////////////////////////////////////////////////////////
+void BoardTester::test_NullMove()
+{
+   MyBoard board;
+   MyBoard passed;
+   board.SetBitBoard(MyState("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1").m_BitBoard);
+   passed.SetBitBoard(MyState("4k3/8/8/3pP3/8/8/8/4K3 b - - 0 1").m_BitBoard);
+   const uint64_t key = board.GetKey();
+   const int numMoves = board.MoveCount();
+   
+   board.MakeNullMove();
+   ASSERT(board.BlacksTurn());
+   ASSERT_EQ(passed.GetKey(), board.GetKey());
+   ASSERT_EQ(passed.MoveCount(), board.MoveCount());
+   ASSERT_EQ(1, board.NumMovesMade());
+   
+   board.UnmakeMove();
+   ASSERT(!board.BlacksTurn());
+   ASSERT_EQ(key, board.GetKey());
+   ASSERT_EQ(numMoves, board.MoveCount());
+   ASSERT_EQ(0, board.NumMovesMade());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Compare the board with the reference, then make/unmake every
+///           move down to the depth
+///
+///   @return  The number of leaf nodes
+///
+////////////////////////////////////////////////////////////////////////////////
+int BoardTester::MakeUnmake(MyBoard& board, MyBoard& reference, int depth)
+{
+   MoveList moves;
+   board.GetTurnPlayerMoves(moves);
+   
+   // Everything kept up to date incrementally should match a fresh board
+   MoveList referenceMoves;
+   reference.SetBitBoard(board.GetBitBoard());
+   reference.GetTurnPlayerMoves(referenceMoves);
+   ASSERT_EQUAL_ACTIONS(ToSet(referenceMoves), ToSet(moves));
+   ASSERT_EQ(reference.InCheck(), board.InCheck());
+   ASSERT_EQ(reference.m_MyPieces->pos_mask, board.m_MyPieces->pos_mask);
+   ASSERT_EQ(reference.m_TheirPieces->pos_mask, board.m_TheirPieces->pos_mask);
+   for (int pos = 0; pos < 64; ++pos)
+   {
+      ASSERT_EQ(reference.m_IndexAt[pos], board.m_IndexAt[pos]);
+   }
+   
+   // Counting and generating by stage should agree with the full list
+   MoveList captures;
+   MoveList quiets;
+   board.GetTurnPlayerMoves(captures, board.CaptureMask());
+   board.GetTurnPlayerMoves(quiets, ~board.CaptureMask());
+   ASSERT_EQ(moves.Size(), board.MoveCount());
+   ASSERT_EQ(moves.Size(), captures.Size() + quiets.Size());
+   
+   // A quiescence search's moves are the captures plus the other promotions
+   MoveList quiescent;
+   board.GetTurnPlayerCaptures(quiescent);
+   std::set<Action, std::greater<Action> > expected = ToSet(captures);
+   int numExpected = captures.Size();
+   for (int i = 0; i < quiets.Size(); ++i)
+   {
+      if (quiets.Get(i).promoted)
+      {
+         expected.insert(quiets.Get(i));
+         ++numExpected;
+      }
+   }
+   ASSERT_EQUAL_ACTIONS(expected, ToSet(quiescent));
+   ASSERT_EQ(numExpected, quiescent.Size());
+   
+   if (depth == 0)
+   {
+      return 1;
+   }
+   
+   int nodes = 0;
+   for (int i = 0; i < moves.Size(); ++i)
+   {
+      Action action = moves.Get(i);
+      BitBoard before = board.GetBitBoard();
+      uint64_t myPosMask = board.m_MyPieces->pos_mask;
+      uint64_t theirPosMask = board.m_TheirPieces->pos_mask;
+      
+      board.MakeMove(action);
+      nodes += MakeUnmake(board, reference, depth - 1);
+      board.UnmakeMove();
+      
+      ASSERT_EQ(before, board.GetBitBoard());
+      ASSERT_EQ(myPosMask, board.m_MyPieces->pos_mask);
+      ASSERT_EQ(theirPosMask, board.m_TheirPieces->pos_mask);
+   }
+   return nodes;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  Seed the static board with the state's bit board then retrieve
@@ -392,10 +529,26 @@ void BoardTester::test_Fen4_BishopMoves()
 ///
 ////////////////////////////////////////////////////////////////////////////////
 std::set<Action, std::greater<Action> > BoardTester::GetActions(const MyState& state)
+{
+   MoveList moves;
+   MyState::s_Board.SetBitBoard(state.m_BitBoard);
+   MyState::s_Board.GetTurnPlayerMoves(moves);
+   return ToSet(moves);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Copy the moves into a set (sorted by position) to compare them
+///
+////////////////////////////////////////////////////////////////////////////////
+std::set<Action, std::greater<Action> > BoardTester::ToSet(const MoveList& moves)
 {
    std::set<Action, std::greater<Action> > actions;
-   MyState::s_Board.GetPiecesAndMasks(state.m_BitBoard.array);
-   MyState::s_Board.GetTurnPlayerMoves(actions);
+   for (int i = 0; i < moves.Size(); ++i)
+   {
+      actions.insert(moves.Get(i));
+   }
    return actions;
 }
 
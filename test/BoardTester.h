@@ -2,6 +2,7 @@
 
 #include "ai/State.h"
 #include "board/Board.h"
+#include <set>
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -29,6 +30,8 @@ protected:
    static void test_Fen2_KingMoves();
    static void test_Fen3_PawnMoves();
    static void test_Fen4_BishopMoves();
+   static void test_MakeUnmake();
+   static void test_NullMove();
    
    
    /////////////////////////////////////////////////////////////////////////////
@@ -56,10 +59,13 @@ protected:
       using Board::m_MyPieces;
       using Board::m_TheirPieces;
       using Board::m_Masks;
+      using Board::m_IndexAt;
    };
    
    
+   static int MakeUnmake(MyBoard& board, MyBoard& reference, int depth);
    static std::set<Action, std::greater<Action> > GetActions(const MyState& state);
+   static std::set<Action, std::greater<Action> > ToSet(const MoveList& moves);
 };
 
 
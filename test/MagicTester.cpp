@@ -0,0 +1,371 @@
+
+
+#include "MagicTester.h"
+#include "ai/TerminalException.h"
+#include "board/Magic.h"
+#include "pieces/Bishop.h"
+#include "pieces/King.h"
+#include "pieces/Knight.h"
+#include "pieces/Pawn.h"
+#include "pieces/Queen.h"
+#include "pieces/Rook.h"
+#include "io/Debug.h"
+#include "io/Error.h"
+#include <vector>
+
+
+// Directions as {col, row} steps, in the order the ray walker used them
+static const int ROOK_DIRECTIONS[4][2]   = {{-1, 0}, {1, 0}, {0, 1}, {0, -1}};
+static const int BISHOP_DIRECTIONS[4][2] = {{-1, 1}, {-1, -1}, {1, 1}, {1, -1}};
+static const int QUEEN_DIRECTIONS[8][2]  = {{-1, 0}, {1, 0}, {0, 1}, {0, -1},
+                                            {-1, 1}, {-1, -1}, {1, 1}, {1, -1}};
+
+// Every combination of the options that matter to a slider
+static constexpr int NUM_OPTION_COMBOS = 16;
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Run all the tests
+///
+////////////////////////////////////////////////////////////////////////////////
+void MagicTester::RunTests()
+{
+   test_RandomOccupancy();
+   test_PerftEquivalence();
+   test_Leapers();
+   test_MagicNumbers();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Throw random pieces on the board and compare every slider mask
+///           against the ray walker, for every position and set of options
+///
+////////////////////////////////////////////////////////////////////////////////
+void MagicTester::test_RandomOccupancy()
+{
+   for (int pos = 0; pos < 64; ++pos)
+   {
+      uint64_t posMask = 1ULL << pos;
+      for (int trial = 0; trial < 64; ++trial)
+      {
+         uint64_t occupied = Random() & Random() & ~posMask;
+         uint64_t mine = occupied & Random();
+         uint64_t theirs = occupied & ~mine;
+         uint64_t theirKing = (trial % 4 == 0 || !theirs) ? 0 : (theirs & -theirs);
+         Piece::PlayerMasks playerMasks(mine | posMask, theirs, 0, theirKing, 0);
+
+         for (int i = 0; i < NUM_OPTION_COMBOS; ++i)
+         {
+            Piece::MaskOptions maskOptions(i & 1, i & 2, i & 4, i & 8);
+            ASSERT_EQ(RayWalk(pos, ROOK_DIRECTIONS, 4, playerMasks, maskOptions),
+                      Rook::MoveMask(pos, playerMasks, maskOptions));
+            ASSERT_EQ(RayWalk(pos, BISHOP_DIRECTIONS, 4, playerMasks, maskOptions),
+                      Bishop::MoveMask(pos, playerMasks, maskOptions));
+            ASSERT_EQ(RayWalk(pos, QUEEN_DIRECTIONS, 8, playerMasks, maskOptions),
+                      Queen::MoveMask(pos, playerMasks, maskOptions));
+         }
+      }
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Walk the perft tree of some well known positions. At every node
+///           compare the slider masks for both players with the ray walker,
+///           then confirm the node counts still match the published ones.
+///
+////////////////////////////////////////////////////////////////////////////////
+void MagicTester::test_PerftEquivalence()
+{
+   struct PerftCase
+   {
+      std::string fen;
+      int depth;
+      uint64_t nodes;
+   };
+
+   static const PerftCase CASES[] = {
+      {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",                  3,  8902}, // start
+      {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",      2,  2039}, // kiwipete
+      {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",                                 3,  2812}, // en passant pins
+      {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",          2,   264},
+      {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",                 2,  1486},
+      {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",  2,  2079},
+   };
+
+   for (const PerftCase& perftCase : CASES)
+   {
+      MyState state(perftCase.fen);
+      ASSERT_EQ(perftCase.nodes, Perft(state, perftCase.depth));
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The knight, king and pawn attack tables should match the move
+///           masks of those pieces on an empty board
+///
+////////////////////////////////////////////////////////////////////////////////
+void MagicTester::test_Leapers()
+{
+   static const Piece::MaskOptions GUARD(true, true); // Pawn captures only
+   for (int pos = 0; pos < 64; ++pos)
+   {
+      Piece::PlayerMasks white;
+      Piece::PlayerMasks black;
+      black.black = true;
+      ASSERT_EQ(Knight::MoveMask(pos, white), Magic::KnightAttacks(pos));
+      ASSERT_EQ(King::MoveMask(pos, white), Magic::KingAttacks(pos));
+      if (pos % 8 != 0 && pos % 8 != 7) // A pawn is never on the first or last row
+      {
+         ASSERT_EQ(Pawn::MoveMask(pos, white, GUARD), Magic::PawnAttacks(false, pos));
+         ASSERT_EQ(Pawn::MoveMask(pos, black, GUARD), Magic::PawnAttacks(true, pos));
+      }
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The precomputed magic numbers should send every occupancy of
+///           each position's blockers to a slot no other attack mask needs
+///           (checked by the multiply even when BMI2 indexes the tables), and
+///           every lookup should match walking the rays
+///
+////////////////////////////////////////////////////////////////////////////////
+void MagicTester::test_MagicNumbers()
+{
+   for (bool rook : {true, false})
+   {
+      const int (*directions)[2] = rook ? ROOK_DIRECTIONS : BISHOP_DIRECTIONS;
+      const uint64_t* magics = rook ? MyMagic::ROOK_MAGICS : MyMagic::BISHOP_MAGICS;
+      for (int pos = 0; pos < 64; ++pos)
+      {
+         uint64_t mask = MyMagic::RelevantMask(pos, directions);
+         int bits = __builtin_popcountll(mask);
+         std::vector<uint64_t> slots(1 << bits, 0); // 0 if unused (never an attack mask)
+         uint64_t subset = 0;
+         do
+         {
+            uint64_t attacks = MyMagic::SlowAttacks(pos, subset, directions);
+            uint64_t& slot = slots[(subset * magics[pos]) >> (64 - bits)];
+            ASSERT(slot == 0 || slot == attacks);
+            slot = attacks;
+            ASSERT_EQ(attacks, rook ? Magic::RookAttacks(pos, subset) : Magic::BishopAttacks(pos, subset));
+            subset = (subset - mask) & mask;
+         }
+         while (subset);
+      }
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Count the leaf nodes at the depth, comparing sliders on the way
+///
+///           Every child is created before recursing, because ApplyAction
+///           expects the static board to still hold the parent.
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t MagicTester::Perft(const MyState& state, int depth)
+{
+   CompareSliders(state);
+   if (depth == 0)
+   {
+      return 1;
+   }
+
+   MoveList moves;
+   try
+   {
+      state.GetValidActions(moves);
+   }
+   catch (const TerminalException&)
+   {
+      return 0;
+   }
+
+   std::vector<MyState> children;
+   children.reserve(moves.Size());
+   for (int i = 0; i < moves.Size(); ++i)
+   {
+      Action action = moves.Get(i);
+      children.emplace_back(state);
+      children.back().ApplyAction(action);
+   }
+
+   uint64_t nodes = 0;
+   for (const MyState& child : children)
+   {
+      nodes += Perft(child, depth - 1);
+   }
+   return nodes;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Compare every slider on the board (including promoted pawns)
+///           with the masks the board would use for it
+///
+////////////////////////////////////////////////////////////////////////////////
+void MagicTester::CompareSliders(const MyState& state)
+{
+   MyBoard board;
+   board.SetBitBoard(state.m_BitBoard);
+   board.InCheck(); // Fill the masks
+   for (PieceType type : {QUEEN, ROOK, BISHOP})
+   {
+      for (uint64_t posMasks = board.m_MyPieces->byType[type]; posMasks; posMasks &= posMasks - 1)
+      {
+         CompareSlider(type, Translate::MaskToPos(posMasks & -posMasks), board.m_Masks.myMasks);
+      }
+      for (uint64_t posMasks = board.m_TheirPieces->byType[type]; posMasks; posMasks &= posMasks - 1)
+      {
+         CompareSlider(type, Translate::MaskToPos(posMasks & -posMasks), board.m_Masks.theirMasks);
+      }
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Compare one slider with the ray walker, for every set of options
+///
+////////////////////////////////////////////////////////////////////////////////
+void MagicTester::CompareSlider(PieceType type, int pos, const Piece::PlayerMasks& playerMasks)
+{
+   const int (*directions)[2] = nullptr;
+   int numDirections = 4;
+
+   switch (type)
+   {
+      case ROOK:   directions = ROOK_DIRECTIONS; break;
+      case BISHOP: directions = BISHOP_DIRECTIONS; break;
+      case QUEEN:  directions = QUEEN_DIRECTIONS; numDirections = 8; break;
+      default: return; // Not a slider
+   }
+
+   for (int i = 0; i < NUM_OPTION_COMBOS; ++i)
+   {
+      Piece::MaskOptions maskOptions(i & 1, i & 2, i & 4, i & 8);
+      uint64_t expected = RayWalk(pos, directions, numDirections, playerMasks, maskOptions);
+      uint64_t actual = Piece::MoveMask(type, pos, playerMasks, maskOptions);
+      if (expected != actual)
+      {
+         debug::Print(Piece::Name(type) + " options " + std::to_string(i));
+         debug::PrintMasks(expected, actual, true);
+      }
+      ASSERT_EQ(expected, actual);
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The original slider implementation - walk each ray one square
+///           at a time
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t MagicTester::RayWalk(int pos, const int directions[][2], int numDirections,
+                              const Piece::PlayerMasks& playerMasks, const Piece::MaskOptions& maskOptions)
+{
+   uint64_t moveMask = 0;
+   for (int d = 0; d < numDirections; ++d)
+   {
+      int through = 0;
+      int col = pos / 8 + directions[d][0];
+      int row = pos % 8 + directions[d][1];
+      for (; col >= 0 && col < 8 && row >= 0 && row < 8; col += directions[d][0], row += directions[d][1])
+      {
+         if (!ApplyPosToMask(moveMask, 1ULL << (col * 8 + row), through, playerMasks, maskOptions))
+         {
+            break;
+         }
+      }
+
+      // Attacking a king in this direction?
+      if (FindBlockableKingAttack(moveMask, playerMasks, maskOptions))
+      {
+         return moveMask;
+      }
+   }
+   return moveMask;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Apply the position to the moves bit-mask. If 'guard' is
+///           specified, apply it even if the pos is also occupied by another
+///           one of our pieces.
+///
+///   @return  true if the position didn't match one of my pieces or their
+///            pieces or if this is their king and we are attacking through it
+///
+////////////////////////////////////////////////////////////////////////////////
+bool MagicTester::ApplyPosToMask(uint64_t& moveMask, uint64_t posMask, int& through,
+                                 const Piece::PlayerMasks& playerMasks, const Piece::MaskOptions& maskOptions)
+{
+   bool myPiece = (posMask & playerMasks.myPieces);
+   bool theirPiece = (posMask & playerMasks.theirPieces);
+   bool theirKing = (posMask & playerMasks.theirKing);
+   bool throughKing = (theirKing && maskOptions.throughKing);
+   bool throughNotKing = (theirPiece && !theirKing && maskOptions.throughNotKingOnce && ++through <= 1);
+
+   if (!myPiece || maskOptions.guard)
+   {
+      moveMask |= posMask;
+   }
+   return (!myPiece && !theirPiece) || throughKing || throughNotKing;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  If we are looking for a king attack that can be blocked, omit
+///           the target king from the bit mask if we find it, but reset the
+///           bit mask if we don't find it.
+///
+///   @return  true if we found the attack bitmap we are looking for
+///
+////////////////////////////////////////////////////////////////////////////////
+bool MagicTester::FindBlockableKingAttack(uint64_t& moveMask, const Piece::PlayerMasks& playerMasks,
+                                          const Piece::MaskOptions& maskOptions)
+{
+   if (maskOptions.blockableKingAttack)
+   {
+      if (moveMask & playerMasks.theirKing)
+      {
+         moveMask &= ~playerMasks.theirKing;
+         return true;
+      }
+      else
+      {
+         moveMask = 0;
+      }
+   }
+   return false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A 64-bit random number (xorshift, so the test is repeatable)
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t MagicTester::Random()
+{
+   static uint64_t seed = 0x2545F4914F6CDD1DULL;
+   seed ^= seed >> 12;
+   seed ^= seed << 25;
+   seed ^= seed >> 27;
+   return seed * 0x2545F4914F6CDD1DULL;
+}
+
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "ai/State.h"
+#include "board/Board.h"
+#include "board/Magic.h"
+#include "pieces/Piece.h"
+#include <cstdint>
+#include <string>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A class for testing the magic bitboard slider attacks against
+///           the ray walker they replaced
+///
+////////////////////////////////////////////////////////////////////////////////
+class MagicTester
+{
+public:
+   static void RunTests();
+
+protected:
+   static void test_RandomOccupancy();
+   static void test_PerftEquivalence();
+   static void test_Leapers();
+   static void test_MagicNumbers();
+
+
+   /////////////////////////////////////////////////////////////////////////////
+   ///
+   ///   @brief  Just need access to the protected members;
+   ///
+   /////////////////////////////////////////////////////////////////////////////
+   class MyState : public State
+   {
+   public:
+      MyState(const std::string& fen) : State(fen) { }
+      explicit MyState(const MyState& other) : State(other) { }
+      using State::m_BitBoard;
+   };
+
+
+   /////////////////////////////////////////////////////////////////////////////
+   ///
+   ///   @brief  Just need access to the protected members;
+   ///
+   /////////////////////////////////////////////////////////////////////////////
+   class MyBoard : public Board
+   {
+   public:
+      using Board::m_MyPieces;
+      using Board::m_TheirPieces;
+      using Board::m_Masks;
+   };
+
+   /////////////////////////////////////////////////////////////////////////////
+   ///
+   ///   @brief  Just need access to the protected members;
+   ///
+   /////////////////////////////////////////////////////////////////////////////
+   class MyMagic : public Magic
+   {
+   public:
+      using Magic::ROOK_MAGICS;
+      using Magic::BISHOP_MAGICS;
+      using Magic::SlowAttacks;
+      using Magic::RelevantMask;
+   };
+
+   static uint64_t Perft(const MyState& state, int depth);
+   static void CompareSliders(const MyState& state);
+   static void CompareSlider(PieceType type, int pos, const Piece::PlayerMasks& playerMasks);
+
+   static uint64_t RayWalk(int pos, const int directions[][2], int numDirections,
+                           const Piece::PlayerMasks& playerMasks, const Piece::MaskOptions& maskOptions);
+   static bool ApplyPosToMask(uint64_t& moveMask, uint64_t posMask, int& through,
+                              const Piece::PlayerMasks& playerMasks, const Piece::MaskOptions& maskOptions);
+   static bool FindBlockableKingAttack(uint64_t& moveMask, const Piece::PlayerMasks& playerMasks,
+                                       const Piece::MaskOptions& maskOptions);
+   static uint64_t Random();
+};
+
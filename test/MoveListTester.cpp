@@ -0,0 +1,109 @@
+
+
+#include "MoveListTester.h"
+#include "board/BitBoard.h"
+#include "io/Error.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Run all the tests
+///
+////////////////////////////////////////////////////////////////////////////////
+void MoveListTester::RunTests()
+{
+   test_AddGet();
+   test_Pick();
+   test_Find();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Every move should unpack to what was added
+///
+////////////////////////////////////////////////////////////////////////////////
+void MoveListTester::test_AddGet()
+{
+   MoveList moves;
+   ASSERT(moves.Empty());
+   
+   moves.Add(0, 63);
+   moves.Add(63, 0);
+   moves.Add(14, 15, true, PROMOTED_TO_N);
+   moves.Add(57, 56, true, PROMOTED_TO_Q);
+   ASSERT_EQ(4, moves.Size());
+   ASSERT(!moves.Empty());
+   
+   Action action = moves.Get(0);
+   ASSERT_EQ(Action(0, 63, Action::UNKNOWN_INDEX), action);
+   ASSERT(!action.promoted);
+   ASSERT_EQ(Action::UNKNOWN_INDEX, action.piece_index);
+   ASSERT_EQ(Action(63, 0, Action::UNKNOWN_INDEX), moves.Get(1));
+   
+   action = moves.Get(2);
+   ASSERT_EQ(Action(14, 15, Action::UNKNOWN_INDEX, true, PROMOTED_TO_N), action);
+   ASSERT(action.promoted);
+   ASSERT_EQ(Action(57, 56, Action::UNKNOWN_INDEX, true, PROMOTED_TO_Q), moves.Get(3));
+   
+   // Fill it up
+   MoveList full;
+   for (int i = 0; i < MoveList::CAPACITY; ++i)
+   {
+      full.Add(i % 64, (i / 64) * 8);
+   }
+   ASSERT_EQ(MoveList::CAPACITY, full.Size());
+   ASSERT_EQ(Action(63, 24, Action::UNKNOWN_INDEX), full.Get(MoveList::CAPACITY - 1));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Moves should be picked by score (ties in the order added)
+///
+////////////////////////////////////////////////////////////////////////////////
+void MoveListTester::test_Pick()
+{
+   MoveList moves;
+   for (int i = 0; i < 6; ++i)
+   {
+      moves.Add(i, i + 8);
+   }
+   moves.SetScore(1, 5);
+   moves.SetScore(3, 9);
+   moves.SetScore(4, 5);
+   moves.SetScore(5, MoveList::FIRST_SCORE);
+   
+   const int expected[] = { 5, 3, 1, 4, 0, 2 };
+   Action action;
+   for (int start_pos : expected)
+   {
+      ASSERT(moves.Pick(action));
+      ASSERT_EQ(Action(start_pos, start_pos + 8, Action::UNKNOWN_INDEX), action);
+   }
+   ASSERT(!moves.Pick(action));
+   ASSERT_EQ(6, moves.Size()); // Picking doesn't remove anything
+   
+   MoveList empty;
+   ASSERT(!empty.Pick(action));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Find should match the promotion type as well as the positions
+///
+////////////////////////////////////////////////////////////////////////////////
+void MoveListTester::test_Find()
+{
+   MoveList moves;
+   moves.Add(6, 7, true, PROMOTED_TO_Q);
+   moves.Add(6, 7, true, PROMOTED_TO_R);
+   moves.Add(6, 14);
+   
+   ASSERT_EQ(1, moves.Find(Action(6, 7, Action::UNKNOWN_INDEX, true, PROMOTED_TO_R)));
+   ASSERT_EQ(2, moves.Find(Action(6, 14, Action::UNKNOWN_INDEX)));
+   ASSERT_EQ(-1, moves.Find(Action(6, 15, Action::UNKNOWN_INDEX)));
+   ASSERT_EQ(-1, moves.Find(Action(6, 7, Action::UNKNOWN_INDEX, true, PROMOTED_TO_N)));
+}
+
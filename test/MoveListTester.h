@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ai/MoveList.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A class for testing the move list
+///
+////////////////////////////////////////////////////////////////////////////////
+class MoveListTester
+{
+public:
+   static void RunTests();
+   
+protected:
+   static void test_AddGet();
+   static void test_Pick();
+   static void test_Find();
+};
+
@@ -0,0 +1,104 @@
+
+
+#include "MovePickerTester.h"
+#include "ai/MovePicker.h"
+#include "io/Error.h"
+#include <functional> // std::greater
+#include <memory>
+#include <set>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Run all the tests
+///
+////////////////////////////////////////////////////////////////////////////////
+void MovePickerTester::RunTests()
+{
+   test_StageOrder();
+   test_InvalidHashAndKillers();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The hash action should come first, then captures by MVV-LVA,
+///           then killers, then the rest of the quiet actions
+///
+////////////////////////////////////////////////////////////////////////////////
+void MovePickerTester::test_StageOrder()
+{
+   // The black queen on d5 can be taken by the pawn, the knight or the rook
+   State state("3rk3/8/8/3q4/4P3/2N5/8/3RK3 w - - 0 1");
+   
+   std::unique_ptr<SearchContext> pContext(new SearchContext());
+   pContext->AddKiller(0, Action("c3", "b5"));
+   pContext->AddKiller(1, Action("c3", "a4")); // Different ply
+   
+   Action hashAction("e1", "f2");
+   std::vector<Action> picked;
+   PickAll(*pContext, state, 0, &hashAction, picked);
+   
+   ASSERT_EQ(state.NumValidActions(), static_cast<int>(picked.size()));
+   ASSERT_EQ(Action("e1", "f2"), picked[0]);
+   ASSERT_EQ(Action("e4", "d5"), picked[1]);
+   ASSERT_EQ(Action("c3", "d5"), picked[2]);
+   ASSERT_EQ(Action("d1", "d5"), picked[3]);
+   ASSERT_EQ(Action("c3", "b5"), picked[4]);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Hash actions and killers that aren't valid for the state (or
+///           are captures in it) should be skipped
+///
+////////////////////////////////////////////////////////////////////////////////
+void MovePickerTester::test_InvalidHashAndKillers()
+{
+   State state("3rk3/8/8/3q4/4P3/2N5/8/3RK3 w - - 0 1");
+   
+   std::unique_ptr<SearchContext> pContext(new SearchContext());
+   pContext->AddKiller(2, Action("e4", "d5")); // A capture here
+   pContext->AddKiller(2, Action("a1", "a2")); // No piece there
+   
+   Action hashAction("d1", "d8"); // Blocked by the queen
+   std::vector<Action> picked;
+   PickAll(*pContext, state, 2, &hashAction, picked);
+   
+   ASSERT_EQ(state.NumValidActions(), static_cast<int>(picked.size()));
+   ASSERT_EQ(Action("e4", "d5"), picked[0]);
+   ASSERT_EQ(Action("c3", "d5"), picked[1]);
+   ASSERT_EQ(Action("d1", "d5"), picked[2]);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Pick every action, checking that each one is valid and picked
+///           only once
+///
+////////////////////////////////////////////////////////////////////////////////
+void MovePickerTester::PickAll(const SearchContext& context, const State& state, int ply, const SimpleAction* pHashAction, std::vector<Action>& picked)
+{
+   MoveList moves;
+   state.GetValidActions(moves);
+   std::set<Action, std::greater<Action> > valid;
+   for (int i = 0; i < moves.Size(); ++i)
+   {
+      valid.insert(moves.Get(i));
+   }
+   
+   std::set<Action, std::greater<Action> > unique;
+   MovePicker picker(context, state, ply, pHashAction);
+   Action action;
+   while (picker.Next(action))
+   {
+      ASSERT_EQ(1U, valid.count(action));
+      ASSERT(unique.insert(action).second);
+      picked.push_back(action);
+   }
+   ASSERT_EQ(valid.size(), unique.size());
+}
+
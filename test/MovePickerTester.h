@@ -0,0 +1,25 @@
+#pragma once
+
+#include "ai/Action.h"
+#include "ai/SearchContext.h"
+#include "ai/State.h"
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A class for testing the move picker
+///
+////////////////////////////////////////////////////////////////////////////////
+class MovePickerTester
+{
+public:
+   static void RunTests();
+   
+protected:
+   static void test_StageOrder();
+   static void test_InvalidHashAndKillers();
+   
+   static void PickAll(const SearchContext& context, const State& state, int ply, const SimpleAction* pHashAction, std::vector<Action>& picked);
+};
+
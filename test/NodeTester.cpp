@@ -0,0 +1,133 @@
+
+
+#include "NodeTester.h"
+#include "io/Error.h"
+#include <memory>
+#include <thread>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Run all the tests
+///
+////////////////////////////////////////////////////////////////////////////////
+void NodeTester::RunTests()
+{
+   test_SuccessorsPerft();
+   test_SuccessorsCutoff();
+   test_ConcurrentSearches();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Walking the tree with successors made one at a time (each one
+///           left made on the board) should reach every node
+///
+////////////////////////////////////////////////////////////////////////////////
+void NodeTester::test_SuccessorsPerft()
+{
+   std::unique_ptr<SearchContext> pContext(new SearchContext());
+   
+   State kiwipete("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+   MyNode root(kiwipete);
+   ASSERT_EQ(2039U, Perft(*pContext, root, 2));
+   
+   State pos3("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+   MyNode root3(pos3);
+   ASSERT_EQ(2812U, Perft(*pContext, root3, 3));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Stopping after the first successor (like a cutoff) should leave
+///           the board holding the parent
+///
+////////////////////////////////////////////////////////////////////////////////
+void NodeTester::test_SuccessorsCutoff()
+{
+   std::unique_ptr<SearchContext> pContext(new SearchContext());
+   State state("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+   MyNode root(state);
+   {
+      Successors successors(*pContext, root);
+      ASSERT_EQ(20, successors.Size());
+      MyNode* pSuccessor = successors.Next();
+      ASSERT_NE(nullptr, pSuccessor);
+      ASSERT_EQ(1, pSuccessor->Depth());
+      ASSERT_NE(state.Key(), pSuccessor->GetState().Key());
+      
+      Successors grandchildren(*pContext, *pSuccessor);
+      ASSERT_EQ(20, grandchildren.Size());
+      ASSERT_NE(nullptr, grandchildren.Next());
+   }
+   
+   // A fresh generator for the root sees the same successors
+   Successors successors(*pContext, root);
+   int numSuccessors = 0;
+   while (successors.Next())
+   {
+      ++numSuccessors;
+   }
+   ASSERT_EQ(20, numSuccessors);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Two searches with their own contexts (so their own boards)
+///           shouldn't get in each other's way, even on separate threads
+///
+////////////////////////////////////////////////////////////////////////////////
+void NodeTester::test_ConcurrentSearches()
+{
+   std::unique_ptr<SearchContext> pContextA(new SearchContext());
+   std::unique_ptr<SearchContext> pContextB(new SearchContext());
+   
+   State kiwipete("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+   State pos3("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+   MyNode rootA(State(kiwipete, pContextA->board));
+   MyNode rootB(State(pos3, pContextB->board));
+   
+   // Each board keeps its own successor made
+   {
+      Successors successorsA(*pContextA, rootA);
+      Successors successorsB(*pContextB, rootB);
+      MyNode* pSuccessorA = successorsA.Next();
+      MyNode* pSuccessorB = successorsB.Next();
+      ASSERT_EQ(pSuccessorA->GetState().Key(), pContextA->board.GetKey());
+      ASSERT_EQ(pSuccessorB->GetState().Key(), pContextB->board.GetKey());
+   }
+   
+   // And the searches count the same nodes at the same time
+   uint64_t nodesB = 0;
+   std::thread thread([&]() { nodesB = Perft(*pContextB, rootB, 4); });
+   uint64_t nodesA = Perft(*pContextA, rootA, 2);
+   thread.join();
+   ASSERT_EQ(2039U, nodesA);
+   ASSERT_EQ(43238U, nodesB);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Count the leaf nodes at the depth
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t NodeTester::Perft(const SearchContext& context, MyNode& node, int depth)
+{
+   if (depth == 0)
+   {
+      return 1;
+   }
+   
+   uint64_t nodes = 0;
+   Successors successors(context, node); // None if terminal
+   while (MyNode* pSuccessor = successors.Next())
+   {
+      nodes += Perft(context, *pSuccessor, depth - 1);
+   }
+   return nodes;
+}
+
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "ai/Node.h"
+#include "ai/SearchContext.h"
+#include <cstdint>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A class for testing search nodes
+///
+////////////////////////////////////////////////////////////////////////////////
+class NodeTester
+{
+public:
+   static void RunTests();
+   
+protected:
+   static void test_SuccessorsPerft();
+   static void test_SuccessorsCutoff();
+   static void test_ConcurrentSearches();
+   
+   static uint64_t Perft(const SearchContext& context, MyNode& node, int depth);
+};
+
@@ -2,7 +2,7 @@
 
 #include "ParserTester.h"
 #include "io/Parser.h"
-#include "board/Board/BitBoard.h"
+#include "board/BitBoard.h"
 #include "io/Error.h"
 #include <bitset>
 #include <iomanip>
@@ -26,6 +26,7 @@ void ParserTester::RunTests()
    test_PromotedKnightsFen();
    test_EnPassantFen();
    test_LateGameFen1();
+   test_HalfMoves();
 }
 
 
@@ -220,6 +221,21 @@ void ParserTester::test_LateGameFen1()
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The half move clock (which can have more than one digit) should
+///           be parsed, but not the full move number after it
+///
+////////////////////////////////////////////////////////////////////////////////
+void ParserTester::test_HalfMoves()
+{
+   ASSERT_EQ(0, Parser("8/5k2/8/8/8/2b5/3P4/4K3 w - -").GetHalfMoves());
+   ASSERT_EQ(0, Parser("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1").GetHalfMoves());
+   ASSERT_EQ(7, Parser("8/5k2/8/8/8/2b5/3P4/4K3 w - - 7 42").GetHalfMoves());
+   ASSERT_EQ(99, Parser("8/5k2/8/8/8/2b5/3P4/4K3 w - - 99 80").GetHalfMoves());
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///   @brief  Throw Error if array contents don't match
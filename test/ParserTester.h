@@ -1,6 +1,6 @@
 #pragma once
 
-#include "board/Board/BitBoard.h"
+#include "board/BitBoard.h"
 #include <string>
 
 
@@ -25,6 +25,7 @@ protected:
    static void test_PromotedKnightsFen();
    static void test_EnPassantFen();
    static void test_LateGameFen1();
+   static void test_HalfMoves();
    // TODO - test en passant
    // TODO - test invalid fen strings
    
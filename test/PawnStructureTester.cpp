@@ -0,0 +1,179 @@
+#include "PawnStructureTester.h"
+#include "ai/PawnTable.h"
+#include "board/Board.h"
+#include "io/Parser.h"
+#include "io/Error.h"
+#include "io/Translate.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Run all the tests
+///
+////////////////////////////////////////////////////////////////////////////////
+void PawnStructureTester::RunTests()
+{
+   test_Passed();
+   test_Penalties();
+   test_Shield();
+   test_Symmetric();
+   test_Table();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A pawn with no opposing pawns in front of it (on its column or
+///           the ones next to it) is passed
+///
+////////////////////////////////////////////////////////////////////////////////
+void PawnStructureTester::test_Passed()
+{
+   // b2 and a7 block each other, h2 is free
+   PawnStructure::Entry entry = Evaluate("4k3/p7/8/8/8/8/1P5P/4K3 w - - 0 1");
+   ASSERT_EQ(Translate::PosToMask(Translate::AlgebraicStrToPos("h2")), entry.passed[0]);
+   ASSERT_EQ(0, entry.passed[1]);
+   ASSERT_EQ(entry.pawns[0] | entry.pawns[1], entry.passed[0] | Translate::PosToMask(Translate::AlgebraicStrToPos("b2")) | Translate::PosToMask(Translate::AlgebraicStrToPos("a7")));
+   
+   // Further advanced is worth more
+   ASSERT_GT(Evaluate("4k3/8/8/8/P7/8/8/4K3 w - - 0 1").score.eg, Evaluate("4k3/8/8/8/8/8/P7/4K3 w - - 0 1").score.eg);
+   
+   // No pawns at all
+   PawnStructure::Entry empty = Evaluate("4k3/8/8/8/8/8/8/4K3 w - - 0 1");
+   ASSERT(Equal(PawnStructure::Entry(), empty));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Doubled, isolated and backward pawns are worth less. Each pair
+///           of positions only differs by the one penalty.
+///
+////////////////////////////////////////////////////////////////////////////////
+void PawnStructureTester::test_Penalties()
+{
+   // Doubled and isolated (a2, a3) vs side by side (a2, b3), all passed
+   PawnStructure::Entry doubled = Evaluate("4k3/8/8/8/8/P7/P7/4K3 w - - 0 1");
+   PawnStructure::Entry split = Evaluate("4k3/8/8/8/8/1P6/P7/4K3 w - - 0 1");
+   ASSERT_EQ(doubled.passed[0], doubled.pawns[0]);
+   ASSERT_EQ(split.passed[0], split.pawns[0]);
+   ASSERT_GT(split.score.mg, doubled.score.mg);
+   ASSERT_GT(split.score.eg, doubled.score.eg);
+   
+   // c2 can't be supported by b4, and d4 guards c3, so c2 is backward
+   PawnStructure::Entry backward = Evaluate("4k3/8/8/1p6/1P1p4/8/2P5/4K3 w - - 0 1");
+   PawnStructure::Entry supported = Evaluate("4k3/8/8/1p6/3p4/8/1PP5/4K3 w - - 0 1");
+   ASSERT_EQ(0, backward.passed[0] | backward.passed[1]);
+   ASSERT_EQ(0, supported.passed[0] | supported.passed[1]);
+   ASSERT_GT(supported.score.mg, backward.score.mg);
+   ASSERT_GT(supported.score.eg, backward.score.eg);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A king that walks away from its pawns loses the shield
+///
+////////////////////////////////////////////////////////////////////////////////
+void PawnStructureTester::test_Shield()
+{
+   static const std::string SHIELDED = "6k1/5ppp/8/8/8/8/5PPP/6K1 w - - 0 1";
+   static const std::string EXPOSED  = "6k1/5ppp/8/8/8/8/5PPP/1K6 w - - 0 1";
+   
+   PawnStructure::Entry entry = Evaluate(SHIELDED);
+   ASSERT(Equal(entry, Evaluate(EXPOSED)));
+   ASSERT_EQ(0, PawnStructure::Shield(entry, Parser(SHIELDED).GetBitBoard().array));
+   ASSERT_GT(0, PawnStructure::Shield(entry, Parser(EXPOSED).GetBitBoard().array));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Flipping the board (and swapping the colors) should negate the
+///           score and swap the masks
+///
+////////////////////////////////////////////////////////////////////////////////
+void PawnStructureTester::test_Symmetric()
+{
+   PawnStructure::Entry entry = Evaluate("4k3/1p3p2/p7/2P3p1/P1P5/8/6PP/4K3 w - - 0 1");
+   PawnStructure::Entry flipped = Evaluate("4k3/6pp/8/p1p5/2p3P1/P7/1P3P2/4K3 b - - 0 1");
+   ASSERT_NE(0, entry.score.mg);
+   ASSERT_EQ(-entry.score.mg, flipped.score.mg);
+   ASSERT_EQ(-entry.score.eg, flipped.score.eg);
+   ASSERT_EQ(__builtin_popcountll(entry.passed[0]), __builtin_popcountll(flipped.passed[1]));
+   ASSERT_EQ(__builtin_popcountll(entry.passed[1]), __builtin_popcountll(flipped.passed[0]));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The pawn key only depends on the pawns, and the table gives back
+///           the same terms as working them out from scratch
+///
+////////////////////////////////////////////////////////////////////////////////
+void PawnStructureTester::test_Table()
+{
+   static const std::string POSITIONS[] = {
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R4RK1 b kq - 1 1", // Same pawns
+      "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+   };
+   
+   Board board;
+   uint64_t keys[3];
+   uint64_t pawnKeys[3];
+   for (int i = 0; i < 3; ++i)
+   {
+      board.SetBitBoard(Parser(POSITIONS[i]).GetBitBoard());
+      keys[i] = board.GetKey();
+      pawnKeys[i] = board.GetPawnKey();
+      
+      const uint8_t* bitBoard = board.GetBitBoard().array;
+      const PawnStructure::Entry& entry = PawnTable::Instance().Probe(pawnKeys[i], bitBoard);
+      ASSERT_EQ(pawnKeys[i], entry.key);
+      ASSERT(Equal(Evaluate(POSITIONS[i]), entry));
+      ASSERT(Equal(entry, PawnTable::Instance().Probe(pawnKeys[i], bitBoard)));
+   }
+   ASSERT_NE(keys[0], keys[1]);
+   ASSERT_EQ(pawnKeys[0], pawnKeys[1]);
+   ASSERT_NE(pawnKeys[0], pawnKeys[2]);
+   
+   // A pawn move changes the pawn key, but not a knight's
+   board.SetBitBoard(Parser(POSITIONS[0]).GetBitBoard());
+   Action knight(Translate::AlgebraicStrToPos("e5"), Translate::AlgebraicStrToPos("g4"), Action::UNKNOWN_INDEX);
+   board.MakeMove(knight);
+   ASSERT_EQ(pawnKeys[0], board.GetPawnKey());
+   Action pawn(Translate::AlgebraicStrToPos("b4"), Translate::AlgebraicStrToPos("b3"), Action::UNKNOWN_INDEX);
+   board.MakeMove(pawn);
+   ASSERT_NE(pawnKeys[0], board.GetPawnKey());
+   board.UnmakeMove();
+   board.UnmakeMove();
+   ASSERT_EQ(pawnKeys[0], board.GetPawnKey());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Work out the pawn structure terms for the position
+///
+////////////////////////////////////////////////////////////////////////////////
+PawnStructure::Entry PawnStructureTester::Evaluate(const std::string& fen)
+{
+   PawnStructure::Entry entry;
+   PawnStructure::Evaluate(Parser(fen).GetBitBoard().array, entry);
+   return entry;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Compare everything in the entries but the key
+///
+////////////////////////////////////////////////////////////////////////////////
+bool PawnStructureTester::Equal(const PawnStructure::Entry& entry, const PawnStructure::Entry& other)
+{
+   return (entry.score == other.score) &&
+          (entry.pawns[0] == other.pawns[0]) && (entry.pawns[1] == other.pawns[1]) &&
+          (entry.passed[0] == other.passed[0]) && (entry.passed[1] == other.passed[1]);
+}
+
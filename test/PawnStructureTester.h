@@ -0,0 +1,27 @@
+#pragma once
+
+#include "board/PawnStructure.h"
+#include <string>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A class for testing the pawn structure terms and pawn table
+///
+////////////////////////////////////////////////////////////////////////////////
+class PawnStructureTester
+{
+public:
+   static void RunTests();
+   
+protected:
+   static void test_Passed();
+   static void test_Penalties();
+   static void test_Shield();
+   static void test_Symmetric();
+   static void test_Table();
+   
+   static PawnStructure::Entry Evaluate(const std::string& fen);
+   static bool Equal(const PawnStructure::Entry& entry, const PawnStructure::Entry& other);
+};
+
@@ -0,0 +1,115 @@
+#include "PstTester.h"
+#include "ai/State.h"
+#include "board/Pst.h"
+#include "io/Parser.h"
+#include "io/Error.h"
+#include <string>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Run all the tests
+///
+////////////////////////////////////////////////////////////////////////////////
+void PstTester::RunTests()
+{
+   test_Symmetric();
+   test_Taper();
+   test_IncrementalMatchesRecompute();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The start is even, and a position flipped (with the colors
+///           swapped) should score the same for its turn player
+///
+////////////////////////////////////////////////////////////////////////////////
+void PstTester::test_Symmetric()
+{
+   Pst::Score start = Pst::Evaluate(Parser("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1").GetBitBoard().array);
+   ASSERT_EQ(0, start.mg);
+   ASSERT_EQ(0, start.eg);
+   ASSERT_EQ(Pst::MAX_PHASE, start.phase);
+   
+   State state("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+   State flipped("rnbqkb1r/pppp1ppp/5n2/4p3/4P3/2N5/PPPP1PPP/R1BQKBNR b KQkq - 2 3");
+   ASSERT_EQ(state.Evaluate(), flipped.Evaluate());
+   ASSERT_GT(state.Evaluate(), 0); // Developed a knight first
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  With only kings and pawns left, the score should be all endgame
+///           (where a king in the center and an advanced pawn are better)
+///
+////////////////////////////////////////////////////////////////////////////////
+void PstTester::test_Taper()
+{
+   Pst::Score score = Pst::Evaluate(Parser("8/8/4k3/8/8/8/P7/K7 w - - 0 1").GetBitBoard().array);
+   ASSERT_EQ(0, score.phase);
+   ASSERT_EQ(score.eg, Pst::Taper(score));
+   
+   Pst::Score advanced = Pst::Evaluate(Parser("8/P7/4k3/8/8/8/8/K7 w - - 0 1").GetBitBoard().array);
+   Pst::Score centered = Pst::Evaluate(Parser("8/8/4k3/8/3K4/8/P7/8 w - - 0 1").GetBitBoard().array);
+   ASSERT_GT(Pst::Taper(advanced), Pst::Taper(score));
+   ASSERT_GT(Pst::Taper(centered), Pst::Taper(score));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Each move updates the score (captures, castling, en passant and
+///           promotions included). It should always match the score for the
+///           bit board calculated from scratch.
+///
+////////////////////////////////////////////////////////////////////////////////
+void PstTester::test_IncrementalMatchesRecompute()
+{
+   static const std::string POSITIONS[] = {
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+      "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+   };
+   
+   Board board;
+   for (const std::string& fen : POSITIONS)
+   {
+      board.SetBitBoard(Parser(fen).GetBitBoard());
+      ASSERT_GT(WalkTree(board, 3), 0);
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Make/unmake every move down to the depth, checking the score
+///
+///   @return  The number of leaf nodes
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t PstTester::WalkTree(Board& board, int depth)
+{
+   ASSERT(Pst::Evaluate(board.GetBitBoard().array) == board.GetScore());
+   if (depth == 0)
+   {
+      return 1;
+   }
+   
+   MoveList moves;
+   board.GetTurnPlayerMoves(moves);
+   
+   uint64_t nodes = 0;
+   for (int i = 0; i < moves.Size(); ++i)
+   {
+      Action action = moves.Get(i);
+      Pst::Score score = board.GetScore();
+      board.MakeMove(action);
+      nodes += WalkTree(board, depth - 1);
+      board.UnmakeMove();
+      ASSERT(score == board.GetScore());
+   }
+   return nodes;
+}
+
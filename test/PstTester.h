@@ -0,0 +1,24 @@
+#pragma once
+
+#include "board/Board.h"
+#include <cstdint>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A class for testing the piece-square score
+///
+////////////////////////////////////////////////////////////////////////////////
+class PstTester
+{
+public:
+   static void RunTests();
+   
+protected:
+   static void test_Symmetric();
+   static void test_Taper();
+   static void test_IncrementalMatchesRecompute();
+   
+   static uint64_t WalkTree(Board& board, int depth);
+};
+
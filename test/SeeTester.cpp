@@ -0,0 +1,88 @@
+
+
+#include "SeeTester.h"
+#include "ai/Action.h"
+#include "board/Board.h"
+#include "io/Parser.h"
+#include "io/Error.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Run all the tests
+///
+////////////////////////////////////////////////////////////////////////////////
+void SeeTester::RunTests()
+{
+   test_Trades();
+   test_XRays();
+   test_King();
+   test_Special();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Free pieces win their value, and defended ones cost the
+///           attacker when it is worth more
+///
+////////////////////////////////////////////////////////////////////////////////
+void SeeTester::test_Trades()
+{
+   ASSERT_EQ(1, See("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1", "e5"));
+   ASSERT_EQ(-2, See("1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3", "e5"));
+   
+   // Trading equal pieces is even
+   ASSERT_EQ(0, See("8/4k3/3r4/8/8/8/3R4/4K3 w - - 0 1", "d2", "d6"));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A slider behind the capturing piece should join the trade
+///
+////////////////////////////////////////////////////////////////////////////////
+void SeeTester::test_XRays()
+{
+   ASSERT_EQ(1, See("3r3k/8/8/3p4/8/8/3R4/K2R4 w - - 0 1", "d2", "d5"));
+   ASSERT_EQ(-4, See("3r3k/8/8/3p4/8/8/3R4/K7 w - - 0 1", "d2", "d5"));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The king can only capture back when nothing is left to defend
+///
+////////////////////////////////////////////////////////////////////////////////
+void SeeTester::test_King()
+{
+   ASSERT_EQ(1, See("8/8/4k3/3p4/8/8/3Q4/K2R4 w - - 0 1", "d2", "d5"));
+   ASSERT_EQ(-8, See("8/8/4k3/3p4/8/8/3Q4/K7 w - - 0 1", "d2", "d5"));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  En passant and promotions
+///
+////////////////////////////////////////////////////////////////////////////////
+void SeeTester::test_Special()
+{
+   ASSERT_EQ(1, See("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5", "d6"));
+   ASSERT_EQ(11, See("1n2k3/P7/8/8/8/8/8/4K3 w - - 0 1", "a7", "b8", "q"));
+   ASSERT_EQ(-1, See("1r2k3/P7/8/8/8/8/8/4K3 w - - 0 1", "a7", "a8", "q"));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Get the static exchange evaluation of an action in a position
+///
+////////////////////////////////////////////////////////////////////////////////
+int SeeTester::See(const std::string& fen, const std::string& from, const std::string& to, const std::string& promotion)
+{
+   Board board;
+   board.SetBitBoard(Parser(fen).GetBitBoard());
+   return board.See(Action(from, to, promotion));
+}
+
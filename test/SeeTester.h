@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A class for testing the static exchange evaluation
+///
+////////////////////////////////////////////////////////////////////////////////
+class SeeTester
+{
+public:
+   static void RunTests();
+   
+protected:
+   static void test_Trades();
+   static void test_XRays();
+   static void test_King();
+   static void test_Special();
+   
+   static int See(const std::string& fen, const std::string& from, const std::string& to, const std::string& promotion = "");
+};
+
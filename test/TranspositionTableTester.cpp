@@ -0,0 +1,233 @@
+
+
+#include "TranspositionTableTester.h"
+#include "board/BitBoard.h"
+#include "io/Error.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Run all the tests
+///
+////////////////////////////////////////////////////////////////////////////////
+void TranspositionTableTester::RunTests()
+{
+   test_StoreProbe();
+   test_Replace();
+   test_NewSearch();
+   test_Disabled();
+   test_Threads();
+   test_MateDistance();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Everything stored should come back out of a probe
+///
+////////////////////////////////////////////////////////////////////////////////
+void TranspositionTableTester::test_StoreProbe()
+{
+   MyTable table(1);
+   TranspositionTable::Entry entry;
+   
+   uint64_t key = 0x123456789ABCDEF0ULL;
+   ASSERT(!table.Probe(key, entry));
+   
+   Action action(12, 15, Action::UNKNOWN_INDEX, true, PROMOTED_TO_N);
+   table.Store(key, 3, TranspositionTable::LOWER, -29990, &action);
+   ASSERT(table.Probe(key, entry));
+   ASSERT_EQ(3, entry.depth);
+   ASSERT_EQ(TranspositionTable::LOWER, entry.bound);
+   ASSERT_EQ(-29990, entry.value);
+   ASSERT(entry.hasAction);
+   ASSERT_EQ(action, entry.action);
+   ASSERT(entry.action.promoted);
+   
+   // Different key, same slot
+   ASSERT(!table.Probe(key ^ (1ULL << 63), entry));
+   
+   // Negative depth (quiescent nodes past the depth limit), no action
+   table.Clear();
+   table.Store(key, -2, TranspositionTable::EXACT, 7, nullptr);
+   ASSERT(table.Probe(key, entry));
+   ASSERT_EQ(-2, entry.depth);
+   ASSERT_EQ(7, entry.value);
+   ASSERT(!entry.hasAction);
+   
+   // Values that don't fit aren't stored
+   table.Clear();
+   table.Store(key, 1, TranspositionTable::EXACT, 100000, nullptr);
+   ASSERT(!table.Probe(key, entry));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A shallower search shouldn't replace a deeper one of the same
+///           key, but a deep entry shouldn't keep other keys out of its
+///           bucket either
+///
+////////////////////////////////////////////////////////////////////////////////
+void TranspositionTableTester::test_Replace()
+{
+   MyTable table(1);
+   TranspositionTable::Entry entry;
+   uint64_t key = 42;
+   
+   table.Store(key, 4, TranspositionTable::EXACT, 4, nullptr);
+   table.Store(key, 2, TranspositionTable::EXACT, 2, nullptr);
+   ASSERT(table.Probe(key, entry));
+   ASSERT_EQ(4, entry.depth);
+   
+   table.Store(key, 5, TranspositionTable::UPPER, 5, nullptr);
+   ASSERT(table.Probe(key, entry));
+   ASSERT_EQ(5, entry.depth);
+   ASSERT_EQ(TranspositionTable::UPPER, entry.bound);
+   
+   // Keys that only differ in the high bits share a bucket
+   uint64_t other1 = key | (1ULL << 62);
+   uint64_t other2 = key | (1ULL << 63);
+   table.Store(other1, 1, TranspositionTable::EXACT, 1, nullptr);
+   ASSERT(table.Probe(other1, entry));
+   ASSERT_EQ(1, entry.depth);
+   table.Store(other2, 1, TranspositionTable::EXACT, 2, nullptr);
+   ASSERT(table.Probe(other2, entry));
+   ASSERT_EQ(2, entry.value);
+   ASSERT(!table.Probe(other1, entry)); // Replaced
+   ASSERT(table.Probe(key, entry)); // Still the deepest
+   ASSERT_EQ(5, entry.depth);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Entries should be kept from one search to the next (even when
+///           the generation wraps), but a new search should replace them
+///           before anything it stored itself
+///
+////////////////////////////////////////////////////////////////////////////////
+void TranspositionTableTester::test_NewSearch()
+{
+   MyTable table(1);
+   TranspositionTable::Entry entry;
+   uint64_t key = 99;
+   uint64_t other = key | (1ULL << 63); // Same bucket
+   
+   table.Store(key, 4, TranspositionTable::EXACT, 4, nullptr);
+   for (int search = 0; search < 200; ++search)
+   {
+      table.NewSearch();
+      ASSERT(table.Probe(key, entry));
+      ASSERT_EQ(4, entry.depth);
+   }
+   
+   // A shallow search from the new search replaces the deep one from the old
+   table.Store(other, 1, TranspositionTable::EXACT, 1, nullptr);
+   ASSERT(table.Probe(other, entry));
+   ASSERT_EQ(1, entry.depth);
+   ASSERT(!table.Probe(key, entry));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  With no size the table never has anything in it
+///
+////////////////////////////////////////////////////////////////////////////////
+void TranspositionTableTester::test_Disabled()
+{
+   MyTable table(0);
+   TranspositionTable::Entry entry;
+   table.Store(1, 1, TranspositionTable::EXACT, 1, nullptr);
+   ASSERT(!table.Probe(1, entry));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Threads hammering the same few slots should never read back an
+///           entry that doesn't belong to the key. Every key gets a value
+///           derived from it, so a mismatch means a torn slot got through.
+///
+////////////////////////////////////////////////////////////////////////////////
+void TranspositionTableTester::test_Threads()
+{
+   static constexpr int NUM_THREADS = 4;
+   static constexpr int NUM_ITERATIONS = 100000;
+   static constexpr uint64_t NUM_KEYS = 64;
+   
+   MyTable table(1);
+   std::atomic<int> numBad(0);
+   std::atomic<int> numHits(0);
+   
+   auto run = [&](int thread)
+   {
+      for (int i = 0; i < NUM_ITERATIONS; ++i)
+      {
+         // Keys that only differ in the high bits share a slot
+         uint64_t key = ((i * 7 + thread) % NUM_KEYS) << 48;
+         int value = static_cast<int>(key >> 48);
+         table.Store(key, value % 8, TranspositionTable::EXACT, -value, nullptr);
+         
+         TranspositionTable::Entry entry;
+         uint64_t probeKey = ((i * 13 + thread) % NUM_KEYS) << 48;
+         if (table.Probe(probeKey, entry))
+         {
+            ++numHits;
+            int expected = static_cast<int>(probeKey >> 48);
+            if (entry.value != -expected || entry.depth != expected % 8)
+            {
+               ++numBad;
+            }
+         }
+      }
+   };
+   
+   std::vector<std::thread> threads;
+   for (int thread = 0; thread < NUM_THREADS; ++thread)
+   {
+      threads.emplace_back(run, thread);
+   }
+   for (std::thread& thread : threads)
+   {
+      thread.join();
+   }
+   
+   ASSERT_GT(numHits, 0);
+   ASSERT_EQ(0, numBad);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A mate should be stored by its distance from the node, so the
+///           same node reached at another ply is that many plies off
+///
+////////////////////////////////////////////////////////////////////////////////
+void TranspositionTableTester::test_MateDistance()
+{
+   MyTable table(1);
+   TranspositionTable::Entry entry;
+   uint64_t key = 7;
+   
+   // Mate 5 plies from the root, found at a node 2 plies in (3 from the node)
+   table.Store(key, 3, TranspositionTable::EXACT, hval::ToTable(hval::MATE - 5, 2), nullptr);
+   ASSERT(table.Probe(key, entry));
+   ASSERT_EQ(hval::MATE - 3, entry.value);
+   ASSERT_EQ(hval::MATE - 7, hval::FromTable(entry.value, 4));
+   
+   // Same for being mated
+   table.Store(key, 3, TranspositionTable::EXACT, hval::ToTable(hval::Mated(6), 2), nullptr);
+   ASSERT(table.Probe(key, entry));
+   ASSERT_EQ(hval::Mated(4), entry.value);
+   ASSERT_EQ(hval::Mated(5), hval::FromTable(entry.value, 1));
+   
+   // Other values aren't changed
+   ASSERT_EQ(250, hval::ToTable(250, 9));
+   ASSERT_EQ(-250, hval::FromTable(-250, 9));
+}
+
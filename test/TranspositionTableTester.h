@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ai/TranspositionTable.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A class for testing the transposition table
+///
+////////////////////////////////////////////////////////////////////////////////
+class TranspositionTableTester
+{
+public:
+   static void RunTests();
+   
+protected:
+   static void test_StoreProbe();
+   static void test_Replace();
+   static void test_NewSearch();
+   static void test_Disabled();
+   static void test_Threads();
+   static void test_MateDistance();
+   
+   
+   /////////////////////////////////////////////////////////////////////////////
+   ///
+   ///   @brief  Need a table that isn't the shared instance
+   ///
+   /////////////////////////////////////////////////////////////////////////////
+   class MyTable : public TranspositionTable
+   {
+   public:
+      MyTable(int megabytes) { Resize(megabytes); }
+   };
+};
+
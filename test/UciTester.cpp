@@ -0,0 +1,248 @@
+#include "UciTester.h"
+#include "ai/MoveList.h"
+#include "ai/Settings.h"
+#include "ai/Timer.h"
+#include "ai/TranspositionTable.h"
+#include "io/Error.h"
+#include <sstream>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Run all the tests
+///
+////////////////////////////////////////////////////////////////////////////////
+void UciTester::RunTests()
+{
+   test_Handshake();
+   test_Position();
+   test_GoDepth();
+   test_InfiniteStop();
+   test_MateScore();
+   test_GoMate();
+   test_GoTime();
+   test_WarmTable();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The engine should identify itself and say when it is ready
+///
+////////////////////////////////////////////////////////////////////////////////
+void UciTester::test_Handshake()
+{
+   std::ostringstream out;
+   std::istringstream in("uci\nisready\nquit\n");
+   MyUci uci(out);
+   uci.Run(in);
+   
+   ASSERT(Contains(out.str(), "id name chess-ai\n"));
+   ASSERT(Contains(out.str(), "option name Threads type spin"));
+   ASSERT(Contains(out.str(), "uciok\n"));
+   ASSERT(Contains(out.str(), "readyok\n"));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Positions should be set from a fen and a list of moves (only
+///           applying the new moves when it is the same game)
+///
+////////////////////////////////////////////////////////////////////////////////
+void UciTester::test_Position()
+{
+   std::ostringstream out;
+   MyUci uci(out);
+   
+   uci.Command("position startpos moves e2e4 e7e5 g1f3");
+   ASSERT_EQ(State("rnbqkbnr/pppp1ppp/8/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R b KQkq - 1 2").Key(), uci.m_State.Key());
+   
+   uci.Command("position startpos moves e2e4 e7e5 g1f3 b8c6");
+   ASSERT_EQ(State("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3").Key(), uci.m_State.Key());
+   
+   uci.Command("position startpos moves d2d4");
+   ASSERT_EQ(State("rnbqkbnr/pppppppp/8/8/3P4/8/PPP1PPPP/RNBQKBNR b KQkq d3 0 1").Key(), uci.m_State.Key());
+   
+   uci.Command("position fen 8/P6k/8/8/8/8/8/K7 w - - 0 1 moves a7a8n");
+   ASSERT_EQ(State("N7/7k/8/8/8/8/8/K7 b - - 0 1").Key(), uci.m_State.Key());
+   
+   ASSERT(!Contains(out.str(), "info string"));
+   uci.Command("position startpos moves e2e5");
+   ASSERT(Contains(out.str(), "info string Illegal move: e2e5\n"));
+   
+   // The game's states are kept to find repetitions, until a pawn move
+   uci.Command("position startpos moves g1f3 g8f6 f3g1 f6g8 g1f3");
+   ASSERT_EQ(5U, uci.m_pContext->gameKeys.size());
+   ASSERT_EQ(State(MyUci::START_FEN).Key(), uci.m_pContext->gameKeys[4]);
+   ASSERT_EQ(5, uci.m_State.HalfMoves());
+   uci.Command("position startpos moves g1f3 g8f6 f3g1 f6g8 g1f3 e7e5");
+   ASSERT_EQ(0U, uci.m_pContext->gameKeys.size());
+   ASSERT_EQ(0, uci.m_State.HalfMoves());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A depth limited search should report each depth, then send a
+///           valid best move (even if the input ends first)
+///
+////////////////////////////////////////////////////////////////////////////////
+void UciTester::test_GoDepth()
+{
+   std::ostringstream out;
+   std::istringstream in("position startpos moves e2e4\ngo depth 2\n");
+   MyUci uci(out);
+   uci.Run(in);
+   
+   ASSERT(Contains(out.str(), "info depth 2 "));
+   size_t i = out.str().find("bestmove ");
+   ASSERT_NE(std::string::npos, i);
+   std::string move = out.str().substr(i + 9, 4);
+   
+   MoveList moves;
+   uci.m_State.GetValidActions(moves);
+   ASSERT(moves.Find(Action(move.substr(0, 2), move.substr(2, 2))) >= 0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  An infinite search should only send its best move once it is
+///           told to stop
+///
+////////////////////////////////////////////////////////////////////////////////
+void UciTester::test_InfiniteStop()
+{
+   Settings& settings = Settings::Instance();
+   int minDepthLimit = settings.min_depth_limit;
+   settings.min_depth_limit = 1; // Always finish depth 1
+   
+   std::ostringstream out;
+   MyUci uci(out);
+   uci.Command("position startpos moves e2e4 e7e5");
+   uci.Command("go infinite");
+   uci.Command("stop");
+   ASSERT(Contains(out.str(), "bestmove "));
+   ASSERT(!Contains(out.str(), "bestmove 0000"));
+   
+   settings.min_depth_limit = minDepthLimit;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Checkmates should be scored in moves, not centipawns (from the
+///           side to move's point of view)
+///
+////////////////////////////////////////////////////////////////////////////////
+void UciTester::test_MateScore()
+{
+   std::ostringstream out;
+   MyUci uci(out);
+   std::istringstream mateIn1("position fen 6k1/5ppp/8/8/8/8/8/R6K w - - 0 1\ngo depth 2\n");
+   uci.Run(mateIn1);
+   ASSERT(Contains(out.str(), " score mate 1 "));
+   ASSERT(Contains(out.str(), "bestmove a1a8\n"));
+   
+   std::istringstream matedIn1("position fen 8/8/8/P7/8/r7/5k1P/7K w - - 0 1\ngo depth 3\n");
+   uci.Run(matedIn1);
+   ASSERT(Contains(out.str(), " score mate -1 "));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A mate search should find a mate in the number of moves (and
+///           stop there), but not claim one that takes longer
+///
+////////////////////////////////////////////////////////////////////////////////
+void UciTester::test_GoMate()
+{
+   std::ostringstream out;
+   MyUci uci(out);
+   std::istringstream mateIn2("position fen kbK5/pp6/1P6/8/8/8/8/R7 w - - 0 1\ngo mate 2\n");
+   uci.Run(mateIn2);
+   ASSERT(Contains(out.str(), " score mate 2 "));
+   ASSERT(Contains(out.str(), "bestmove a1a6\n"));
+   ASSERT(!Contains(out.str(), "info depth 5 "));
+   
+   std::ostringstream tooFew;
+   MyUci uci2(tooFew);
+   std::istringstream mateIn1("position fen kbK5/pp6/1P6/8/8/8/8/R7 w - - 0 1\ngo mate 1\n");
+   uci2.Run(mateIn1);
+   ASSERT(!Contains(tooFew.str(), " score mate"));
+   ASSERT(Contains(tooFew.str(), "bestmove "));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Check to see if the engine's output contains the text
+///
+////////////////////////////////////////////////////////////////////////////////
+bool UciTester::Contains(const std::string& output, const std::string& text)
+{
+   return output.find(text) != std::string::npos;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  With a clock, each move should get a share of the time left plus
+///           most of the increment, and the hard limit should allow a few
+///           times that (but never most of what is left)
+///
+////////////////////////////////////////////////////////////////////////////////
+void UciTester::test_GoTime()
+{
+   Settings& settings = Settings::Instance();
+   Settings saved = settings;
+   settings.seconds_limit = -1.0;
+   
+   Timer& timer = Timer::Instance();
+   timer.Restart(10.05, 1.0, 0); // Soft 10 / 30 + 0.75, hard 4 times that
+   ASSERT(!timer.PastSoftLimit());
+   ASSERT(timer.CanFinish(4.2));
+   ASSERT(!timer.CanFinish(4.4));
+   timer.Restart(10.05, 0.0, 1); // Soft 10, hard half of that
+   ASSERT(timer.CanFinish(4.9));
+   ASSERT(!timer.CanFinish(5.1));
+   
+   std::ostringstream out;
+   MyUci uci(out);
+   std::istringstream in("position startpos\ngo wtime 2000 btime 2000 winc 10 binc 10 movestogo 40\n");
+   uci.Run(in);
+   ASSERT(Contains(out.str(), "bestmove "));
+   ASSERT_LT(timer.Elapsed(), 1.0); // Hard limit under 0.2s
+   
+   settings = saved;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  After a move is played, the next search should start with what
+///           the last one stored for its root
+///
+////////////////////////////////////////////////////////////////////////////////
+void UciTester::test_WarmTable()
+{
+   std::ostringstream out;
+   MyUci uci(out);
+   std::istringstream in("setoption name Hash value 1\nposition startpos\ngo depth 4\n");
+   uci.Run(in);
+   
+   const std::string& str = out.str();
+   size_t i = str.find("bestmove ");
+   ASSERT_NE(std::string::npos, i);
+   std::string best = str.substr(i + 9, 4);
+   
+   uci.Command("position startpos moves " + best);
+   TranspositionTable::Entry entry;
+   ASSERT(TranspositionTable::Instance().Probe(uci.m_State.Key(), entry));
+   ASSERT(entry.hasAction);
+   
+   uci.Command("setoption name Hash value 0");
+}
+
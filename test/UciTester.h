@@ -0,0 +1,40 @@
+#pragma once
+
+#include "io/Uci.h"
+#include <string>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A class for testing the UCI engine loop
+///
+////////////////////////////////////////////////////////////////////////////////
+class UciTester
+{
+public:
+   static void RunTests();
+   
+protected:
+   
+   // Give access to the current state
+   class MyUci : public Uci
+   {
+   public:
+      using Uci::Uci;
+      using Uci::m_State;
+      using Uci::m_pContext;
+      using Uci::START_FEN;
+   };
+   
+   static void test_Handshake();
+   static void test_Position();
+   static void test_GoDepth();
+   static void test_InfiniteStop();
+   static void test_MateScore();
+   static void test_GoMate();
+   static void test_GoTime();
+   static void test_WarmTable();
+   
+   static bool Contains(const std::string& output, const std::string& text);
+};
+
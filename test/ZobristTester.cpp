@@ -0,0 +1,143 @@
+
+
+#include "ZobristTester.h"
+#include "ai/Settings.h"
+#include "ai/State.h"
+#include "board/Zobrist.h"
+#include "io/Parser.h"
+#include "io/Error.h"
+#include <string>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Run all the tests
+///
+////////////////////////////////////////////////////////////////////////////////
+void ZobristTester::RunTests()
+{
+   test_Transposition();
+   test_TurnAndCastle();
+   test_IncrementalMatchesRecompute();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The same position reached with the moves in a different order
+///           should get the same key as the fen for it, even though the
+///           knights end up in different slots of the bit board
+///
+////////////////////////////////////////////////////////////////////////////////
+void ZobristTester::test_Transposition()
+{
+   static const std::string START = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+   static const std::string END   = "r1bqkb1r/pppp1ppp/2n2n2/4p3/4P3/2N2N2/PPPP1PPP/R1BQKB1R w KQkq - 4 4";
+   
+   State state1(START);
+   Action a1[] = {Action("e2", "e4"), Action("e7", "e5"), Action("g1", "f3"), Action("b8", "c6"), Action("b1", "c3"), Action("g8", "f6")};
+   for (Action& action : a1)
+   {
+      state1.ApplyAction(action);
+   }
+   
+   State state2(START);
+   Action a2[] = {Action("b1", "c3"), Action("g8", "f6"), Action("e2", "e4"), Action("e7", "e5"), Action("g1", "f3"), Action("b8", "c6")};
+   for (Action& action : a2)
+   {
+      state2.ApplyAction(action);
+   }
+   
+   ASSERT_NE(State(START).Key(), state1.Key());
+   ASSERT_EQ(state1.Key(), state2.Key());
+   ASSERT_EQ(State(END).Key(), state1.Key());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  The turn player and castle rights should be part of the key
+///
+////////////////////////////////////////////////////////////////////////////////
+void ZobristTester::test_TurnAndCastle()
+{
+   static const std::string WHITE  = "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1";
+   static const std::string BLACK  = "r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1";
+   static const std::string CASTLE = "r3k2r/8/8/8/8/8/8/R3K2R w Kq - 0 1";
+   
+   State state(WHITE);
+   uint64_t whiteKey = state.Key();
+   
+   state.SwapTurnPlayer();
+   ASSERT_EQ(State(BLACK).Key(), state.Key());
+   ASSERT_NE(whiteKey, state.Key());
+   
+   state.SwapTurnPlayer();
+   ASSERT_EQ(whiteKey, state.Key());
+   
+   ASSERT_NE(whiteKey, State(CASTLE).Key());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Walk the move tree of positions with castling, en passant and
+///           promotions. Every move checks the incremental key against a
+///           full recompute, and every unmake should restore the key.
+///
+////////////////////////////////////////////////////////////////////////////////
+void ZobristTester::test_IncrementalMatchesRecompute()
+{
+   static const std::string POSITIONS[] = {
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+      "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+   };
+   
+   Settings& settings = Settings::Instance();
+   bool verifyHash = settings.verify_hash;
+   settings.verify_hash = true;
+   
+   Board board;
+   for (const std::string& fen : POSITIONS)
+   {
+      board.SetBitBoard(Parser(fen).GetBitBoard());
+      ASSERT_GT(WalkTree(board, 3), 0);
+   }
+   
+   settings.verify_hash = verifyHash;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Make/unmake every move down to the depth
+///
+///   @return  The number of leaf nodes
+///
+////////////////////////////////////////////////////////////////////////////////
+uint64_t ZobristTester::WalkTree(Board& board, int depth)
+{
+   if (depth == 0)
+   {
+      return 1;
+   }
+   
+   MoveList moves;
+   board.GetTurnPlayerMoves(moves);
+   
+   uint64_t nodes = 0;
+   for (int i = 0; i < moves.Size(); ++i)
+   {
+      Action action = moves.Get(i);
+      uint64_t key = board.GetKey();
+      uint64_t pawnKey = board.GetPawnKey();
+      board.MakeMove(action); // Checks the keys
+      nodes += WalkTree(board, depth - 1);
+      board.UnmakeMove();
+      ASSERT_EQ(key, board.GetKey());
+      ASSERT_EQ(pawnKey, board.GetPawnKey());
+   }
+   return nodes;
+}
+
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "board/Board.h"
+#include <cstdint>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A class for testing the Zobrist keys
+///
+////////////////////////////////////////////////////////////////////////////////
+class ZobristTester
+{
+public:
+   static void RunTests();
+   
+protected:
+   static void test_Transposition();
+   static void test_TurnAndCastle();
+   static void test_IncrementalMatchesRecompute();
+   
+   static uint64_t WalkTree(Board& board, int depth);
+};
+
@@ -1,9 +1,20 @@
 
 
-#include "tests/BitBoardTester.h"
-#include "tests/BoardTester.h"
-#include "tests/ParserTester.h"
-#include "tests/TranslateTester.h"
+#include "test/AiHelperTester.h"
+#include "test/BitBoardTester.h"
+#include "test/BoardTester.h"
+#include "test/MagicTester.h"
+#include "test/MoveListTester.h"
+#include "test/MovePickerTester.h"
+#include "test/NodeTester.h"
+#include "test/ParserTester.h"
+#include "test/PawnStructureTester.h"
+#include "test/PstTester.h"
+#include "test/SeeTester.h"
+#include "test/TranslateTester.h"
+#include "test/TranspositionTableTester.h"
+#include "test/UciTester.h"
+#include "test/ZobristTester.h"
 #include "ai/Settings.h"
 #include "board/BitBoard.h"
 #include "io/Error.h"
@@ -28,6 +39,17 @@ int main()
       BitBoardTester::RunTests();
       ParserTester::RunTests();
       BoardTester::RunTests();
+      MagicTester::RunTests();
+      SeeTester::RunTests();
+      MoveListTester::RunTests();
+      MovePickerTester::RunTests();
+      NodeTester::RunTests();
+      ZobristTester::RunTests();
+      PstTester::RunTests();
+      PawnStructureTester::RunTests();
+      TranspositionTableTester::RunTests();
+      AiHelperTester::RunTests();
+      UciTester::RunTests();
       std::cout << "SUCCESS - All tests passed." << std::endl;
    }
    catch (const Error& e)
@@ -0,0 +1,259 @@
+#include "ai/AiHelper.h"
+#include "ai/SearchContext.h"
+#include "ai/Settings.h"
+#include "ai/State.h"
+#include "ai/Timer.h"
+#include "ai/TranspositionTable.h"
+#include "board/Board.h"
+#include "io/Error.h"
+#include "io/Parser.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+// Middlegame and endgame positions with no quick mate (the search would stop)
+static const char* POSITIONS[] = {
+   "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+   "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+   "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+   "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Use the same settings as a real game, but with a fixed time
+///           for each search
+///
+////////////////////////////////////////////////////////////////////////////////
+static void InitSettings(double seconds)
+{
+   Settings& settings = Settings::Instance();
+   settings.silent           = true;
+   settings.verbose          = false;
+   settings.very_verbose     = false;
+   settings.random           = false;
+   settings.alpha_beta       = true;
+   settings.history_table    = true;
+   settings.pvs              = true;
+   settings.pondering        = false;
+   settings.seconds_limit    = seconds;
+   settings.quiescent        = true;
+   settings.null_move        = true;
+   settings.lmr              = true;
+   settings.extensions       = true;
+   settings.hash_mb          = 16;
+   settings.threads          = 1;
+   settings.min_depth_limit  = 2;
+   settings.max_depth_limit  = 0;
+   settings.mate_moves       = 0;
+   settings.even_depths_only = true;
+   settings.verify_hash      = false;
+   settings.test             = false;
+   settings.Validate();
+   TranspositionTable::Instance().Resize(settings.hash_mb);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Search every position for the time limit, each from an empty
+///           table
+///
+///   @return  The nodes per second over all the positions
+///
+////////////////////////////////////////////////////////////////////////////////
+static double RunPositions(int threads)
+{
+   Settings::Instance().threads = threads;
+   std::unique_ptr<SearchContext> pContext(new SearchContext());
+   double elapsed = 0.0;
+   for (const char* fen : POSITIONS)
+   {
+      TranspositionTable::Instance().Clear();
+      pContext->history.Reset();
+      pContext->gameKeys.clear();
+      Timer::Instance().Restart();
+      AiHelper::ID_DL_MiniMax(*pContext, State(fen));
+      elapsed += Timer::Instance().Elapsed();
+   }
+   uint64_t nodes = pContext->nodes;
+   double nps = (elapsed > 0) ? nodes / elapsed : 0;
+   std::cout << std::setw(7) << threads << std::setw(14) << nodes
+             << std::fixed << std::setprecision(0) << std::setw(12) << nps;
+   return nps;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Search every position to a fixed depth, each from an empty
+///           table (with a new context)
+///
+///   @return  The total nodes searched
+///
+////////////////////////////////////////////////////////////////////////////////
+static uint64_t RunPositionsToDepth(int depth)
+{
+   Settings& settings = Settings::Instance();
+   settings.threads = 1;
+   settings.min_depth_limit = depth; // Never run out of time
+   settings.max_depth_limit = depth;
+   uint64_t total = 0;
+   for (const char* fen : POSITIONS)
+   {
+      std::unique_ptr<SearchContext> pContext(new SearchContext());
+      TranspositionTable::Instance().Clear();
+      Timer::Instance().Restart();
+      AiHelper::ID_DL_MiniMax(*pContext, State(fen));
+      std::cout << std::setw(14) << pContext->nodes;
+      total += pContext->nodes;
+   }
+   std::cout << std::setw(14) << total;
+   return total;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Compare the nodes searched to a fixed depth with and without
+///           the principal variation search (and aspiration windows)
+///
+////////////////////////////////////////////////////////////////////////////////
+static void CompareNodes(int depth)
+{
+   std::cout << "Depth " << depth << " (nodes per position, then the total)" << std::endl;
+   Settings::Instance().pvs = false;
+   std::cout << "Alpha-beta ";
+   uint64_t before = RunPositionsToDepth(depth);
+   std::cout << std::endl;
+   Settings::Instance().pvs = true;
+   std::cout << "PVS        ";
+   uint64_t after = RunPositionsToDepth(depth);
+   std::cout << std::fixed << std::setprecision(1) << std::setw(8)
+             << (before ? 100.0 * (static_cast<double>(before) - after) / before : 0) << "% fewer" << std::endl;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Time the static exchange evaluation of every capture in the
+///           positions, over and over
+///
+////////////////////////////////////////////////////////////////////////////////
+static void TimeSee(int iterations)
+{
+   Board board;
+   uint64_t calls = 0;
+   int64_t total = 0; // Printed, so the calls can't be optimized out
+   double elapsed = 0.0;
+   for (const char* fen : POSITIONS)
+   {
+      board.SetBitBoard(Parser(fen).GetBitBoard());
+      MoveList captures;
+      board.GetTurnPlayerMoves(captures, board.CaptureMask());
+
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < iterations; ++i)
+      {
+         for (int j = 0; j < captures.Size(); ++j)
+         {
+            total += board.See(captures.Get(j));
+         }
+      }
+      elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      calls += static_cast<uint64_t>(iterations) * captures.Size();
+   }
+   std::cout << "SEE calls     ns/call  (checksum " << total << ")" << std::endl;
+   std::cout << std::setw(9) << calls << std::fixed << std::setprecision(1) << std::setw(12)
+             << (calls ? 1e9 * elapsed / calls : 0) << std::endl;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Measure how the nodes per second scale with the number of
+///           search threads (1, 2, 4, ... up to the max), or (with --depth)
+///           compare the nodes searched to a fixed depth with and without PVS,
+///           or (with --see) time the static exchange evaluation
+///
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+   if (argc > 1 && std::string(argv[1]) == "--see")
+   {
+      int iterations = (argc > 2) ? atoi(argv[2]) : 1000000;
+      try
+      {
+         TimeSee(iterations);
+      }
+      catch (const Error& e)
+      {
+         std::cerr << e.what() << std::endl;
+         return 1;
+      }
+      return 0;
+   }
+
+   if (argc > 1 && std::string(argv[1]) == "--depth")
+   {
+      int depth = (argc > 2) ? atoi(argv[2]) : 4;
+      try
+      {
+         InitSettings(1.0);
+         CompareNodes(depth);
+      }
+      catch (const Error& e)
+      {
+         std::cerr << e.what() << std::endl;
+         return 1;
+      }
+      return 0;
+   }
+
+   double seconds = (argc > 1) ? atof(argv[1]) : 1.0;
+   int maxThreads = (argc > 2) ? atoi(argv[2]) : 1;
+   if (seconds <= 0.0 || maxThreads < 1)
+   {
+      std::cerr << "Usage:  " << argv[0] << " [seconds_per_position] [max_threads]" << std::endl;
+      std::cerr << "        " << argv[0] << " --depth [depth]" << std::endl;
+      std::cerr << "        " << argv[0] << " --see [iterations]" << std::endl;
+      return 1;
+   }
+
+   std::vector<int> threadCounts;
+   for (int threads = 1; threads < maxThreads; threads *= 2)
+   {
+      threadCounts.push_back(threads);
+   }
+   threadCounts.push_back(maxThreads);
+
+   try
+   {
+      InitSettings(seconds);
+      std::cout << "Threads         Nodes         NPS  Speedup" << std::endl;
+      double baseNps = 0.0;
+      for (int threads : threadCounts)
+      {
+         double nps = RunPositions(threads);
+         if (baseNps == 0.0)
+         {
+            baseNps = nps;
+         }
+         std::cout << std::setprecision(2) << std::setw(8) << (baseNps > 0 ? nps / baseNps : 0) << "x" << std::endl;
+      }
+   }
+   catch (const Error& e)
+   {
+      std::cerr << e.what() << std::endl;
+      return 1;
+   }
+   return 0;
+}
+
@@ -0,0 +1,219 @@
+
+
+#include "ai/MoveList.h"
+#include "ai/Timer.h"
+#include "board/Board.h"
+#include "io/Error.h"
+#include "io/Parser.h"
+#include "io/Translate.h"
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  A well known position, with its published node counts
+///
+////////////////////////////////////////////////////////////////////////////////
+struct PerftCase
+{
+   const char* name;
+   const char* fen;
+   int quickDepth;       // Deep enough to be a useful check, quick enough for ctest
+   uint64_t nodes[6];    // Node counts for depths [1, 6] (0 if not listed)
+};
+
+static const PerftCase SUITE[] = {
+   {"start", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 4,
+      {20, 400, 8902, 197281, 4865609, 119060324}},
+   {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3,
+      {48, 2039, 97862, 4085603, 193690690, 0}},
+   {"pos3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5,
+      {14, 191, 2812, 43238, 674624, 11030083}},
+   {"pos4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 3,
+      {6, 264, 9467, 422333, 15833292, 0}},
+   {"pos4 mirrored", "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", 3,
+      {6, 264, 9467, 422333, 15833292, 0}},
+   {"pos5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3,
+      {44, 1486, 62379, 2103487, 89941194, 0}},
+   {"pos6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 3,
+      {46, 2079, 89890, 3894594, 164075551, 0}},
+};
+
+static constexpr int MAX_SUITE_DEPTH = 6;
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Count the leaf nodes at the depth
+///
+///           The whole tree is walked on the one board: each move is made,
+///           counted under, then taken back, so the board holds the same
+///           position on return. The last ply is just counted, not made.
+///
+////////////////////////////////////////////////////////////////////////////////
+static uint64_t Perft(Board& board, int depth)
+{
+   if (depth == 0)
+   {
+      return 1;
+   }
+
+   MoveList moves;
+   board.GetTurnPlayerMoves(moves);
+   if (depth == 1)
+   {
+      return moves.Size();
+   }
+
+   uint64_t nodes = 0;
+   for (int i = 0; i < moves.Size(); ++i)
+   {
+      Action action = moves.Get(i);
+      board.MakeMove(action);
+      nodes += Perft(board, depth - 1);
+      board.UnmakeMove();
+   }
+   return nodes;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Print the node count under each root move, then the total and
+///           the nodes per second
+///
+////////////////////////////////////////////////////////////////////////////////
+static uint64_t Divide(Board& board, int depth)
+{
+   Timer timer;
+
+   MoveList moves;
+   board.GetTurnPlayerMoves(moves);
+
+   uint64_t nodes = 0;
+   for (int i = 0; i < moves.Size(); ++i)
+   {
+      Action action = moves.Get(i);
+      board.MakeMove(action);
+      uint64_t childNodes = Perft(board, depth - 1);
+      board.UnmakeMove();
+      nodes += childNodes;
+
+      std::cout << Translate::PosToAlgebraicStr(action.start_pos)
+                << Translate::PosToAlgebraicStr(action.end_pos)
+                << (action.promoted ? Translate::PromotionIntToStr(action.promoted_type) : "")
+                << ": " << childNodes << std::endl;
+   }
+
+   double elapsed = timer.Elapsed();
+   std::cout << std::endl
+             << "Nodes: " << nodes << std::endl
+             << "Time:  " << std::fixed << std::setprecision(3) << elapsed << " s" << std::endl
+             << "NPS:   " << std::setprecision(0) << (elapsed > 0 ? nodes / elapsed : 0) << std::endl;
+   return nodes;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Run every position in the suite and compare with the published
+///           node counts
+///
+///   @param maxDepth  Run each position this deep (or as deep as it has a
+///                    count for). If 0, use each position's quick depth.
+///
+///   @return  The number of positions that didn't match
+///
+////////////////////////////////////////////////////////////////////////////////
+static int RunSuite(int maxDepth)
+{
+   Board board;
+   int failures = 0;
+   uint64_t totalNodes = 0;
+   Timer totalTimer;
+
+   for (const PerftCase& perftCase : SUITE)
+   {
+      int depth = maxDepth ? maxDepth : perftCase.quickDepth;
+      while (depth > 1 && perftCase.nodes[depth - 1] == 0)
+      {
+         --depth;
+      }
+
+      board.SetBitBoard(Parser(perftCase.fen).GetBitBoard());
+      Timer timer;
+      uint64_t nodes = Perft(board, depth);
+      double elapsed = timer.Elapsed();
+      totalNodes += nodes;
+
+      uint64_t expected = perftCase.nodes[depth - 1];
+      bool pass = (nodes == expected);
+      failures += pass ? 0 : 1;
+
+      std::cout << (pass ? "PASS " : "FAIL ") << std::left << std::setw(14) << perftCase.name
+                << " depth " << depth << ": " << nodes;
+      if (!pass)
+      {
+         std::cout << " (expected " << expected << ")";
+      }
+      std::cout << std::fixed << std::setprecision(3) << "  " << elapsed << " s" << std::endl;
+   }
+
+   double elapsed = totalTimer.Elapsed();
+   std::cout << "Total: " << totalNodes << " nodes, " << std::setprecision(0)
+             << (elapsed > 0 ? totalNodes / elapsed : 0) << " nps" << std::endl;
+   return failures;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///   @brief  Count the moves from a position (or the whole suite) to check
+///           move generation and measure how fast it is
+///
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+   std::string arg1 = (argc > 1) ? argv[1] : "";
+   if (arg1 != "--suite" && argc < 3)
+   {
+      std::cerr << "Usage:  " << argv[0] << " <fen> <depth>" << std::endl
+                << "        " << argv[0] << " --suite [depth]" << std::endl;
+      return 1;
+   }
+
+   try
+   {
+      if (arg1 == "--suite")
+      {
+         int depth = (argc > 2) ? atoi(argv[2]) : 0;
+         if (depth < 0 || depth > MAX_SUITE_DEPTH)
+         {
+            std::cerr << "Suite depth must be in [1, " << MAX_SUITE_DEPTH << "]" << std::endl;
+            return 1;
+         }
+         return RunSuite(depth) ? 1 : 0;
+      }
+
+      int depth = atoi(argv[2]);
+      if (depth < 1)
+      {
+         std::cerr << "Depth must be at least 1" << std::endl;
+         return 1;
+      }
+      Board board;
+      board.SetBitBoard(Parser(argv[1]).GetBitBoard());
+      Divide(board, depth);
+   }
+   catch (const Error& e)
+   {
+      std::cerr << e.what() << std::endl;
+      return 1;
+   }
+   return 0;
+}
+